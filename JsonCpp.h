@@ -1,2 +1,10 @@
 #pragma once
-#include "include/JsonParser.h"
\ No newline at end of file
+#include "include/JsonParser.h"
+#include "include/JsonDocument.h"
+#include "include/JsonMappedFile.h"
+#include "include/JsonTape.h"
+#include "include/JsonDocumentView.h"
+#include "include/JsonStreamParser.h"
+#include "include/JsonLines.h"
+#include "include/JsonPointer.h"
+#include "include/JsonPatch.h"
@@ -0,0 +1,198 @@
+#pragma once
+#include "Utility.h"
+#include <cstdlib>
+#include <cstdint>
+
+namespace Jsoncpp {
+    //JsonArena class
+    //bump allocator over a list of chunks, memory is only given back when the whole arena is reset or released. blocks
+    //counts the node buffers JsonArenaAllocator handed out and has not had back yet
+    struct JsonArena {
+        struct Chunk {
+            Chunk *next;
+            size_t size;
+        };
+
+        static constexpr size_t default_chunk_size = 64 * 1024;
+        static constexpr size_t max_chunk_size = 16 * 1024 * 1024;
+
+        Chunk *head = nullptr;
+        char_ptr cursor = nullptr;
+        char_ptr end = nullptr;
+        size_t next_chunk_size;
+        size_t blocks = 0;
+
+        JsonArena(const size_t& chunk_size = default_chunk_size);
+        JsonArena(const JsonArena &other) = delete;
+        JsonArena(JsonArena &&other) noexcept;
+        JsonArena &operator=(const JsonArena &other) = delete;
+        JsonArena &operator=(JsonArena &&other) noexcept;
+        ~JsonArena();
+        void *allocate(const size_t& bytes, const size_t& alignment);
+        void reset();
+        void release();
+        size_t capacity() const;
+    };
+
+    //JsonArenaAllocator class
+    //a default constructed allocator has no arena and falls back to the global heap
+    template <typename T>
+    struct JsonArenaAllocator {
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+
+        JsonArena *arena = nullptr;
+
+        JsonArenaAllocator() = default;
+        JsonArenaAllocator(JsonArena *a);
+        template <typename U>
+        JsonArenaAllocator(const JsonArenaAllocator<U> &other);
+        T *allocate(const size_t& num);
+        void deallocate(T *ptr, const size_t& num);
+        template <typename U>
+        bool operator==(const JsonArenaAllocator<U> &other) const;
+        template <typename U>
+        bool operator!=(const JsonArenaAllocator<U> &other) const;
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //JsonArena class member function
+
+    inline JsonArena::JsonArena(const size_t& chunk_size) : next_chunk_size(chunk_size) {}
+
+    inline JsonArena::JsonArena(JsonArena &&other) noexcept
+    : head(other.head), cursor(other.cursor), end(other.end), next_chunk_size(other.next_chunk_size), blocks(other.blocks) {
+        other.head = nullptr;
+        other.cursor = nullptr;
+        other.end = nullptr;
+        other.blocks = 0;
+    }
+
+    inline JsonArena& JsonArena::operator=(JsonArena &&other) noexcept {
+        if (this != &other) {
+            release();
+            head = other.head;
+            cursor = other.cursor;
+            end = other.end;
+            next_chunk_size = other.next_chunk_size;
+            blocks = other.blocks;
+            other.head = nullptr;
+            other.cursor = nullptr;
+            other.end = nullptr;
+            other.blocks = 0;
+        }
+        return *this;
+    }
+
+    inline JsonArena::~JsonArena() {
+        release();
+    }
+
+    inline void *JsonArena::allocate(const size_t& bytes, const size_t& alignment) {
+        auto aligned = reinterpret_cast<char_ptr>((reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+        if (!cursor || aligned + bytes > end) {
+            size_t size = next_chunk_size;
+            while (size < bytes + alignment + sizeof(Chunk)) {
+                size *= 2;
+            }
+            auto chunk = static_cast<Chunk *>(std::malloc(size));
+            if (!chunk) {
+                throw std::bad_alloc();
+            }
+            chunk->next = head;
+            chunk->size = size;
+            head = chunk;
+            cursor = reinterpret_cast<char_ptr>(chunk) + sizeof(Chunk);
+            end = reinterpret_cast<char_ptr>(chunk) + size;
+            if (next_chunk_size < max_chunk_size) {
+                next_chunk_size *= 2;
+            }
+            aligned = reinterpret_cast<char_ptr>((reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+        }
+        cursor = aligned + bytes;
+        return aligned;
+    }
+
+    //keeps the newest (largest) chunk for reuse and frees the rest
+    inline void JsonArena::reset() {
+        blocks = 0;
+        if (!head) {
+            return;
+        }
+        auto chunk = head->next;
+        while (chunk) {
+            auto next = chunk->next;
+            std::free(chunk);
+            chunk = next;
+        }
+        head->next = nullptr;
+        cursor = reinterpret_cast<char_ptr>(head) + sizeof(Chunk);
+        end = reinterpret_cast<char_ptr>(head) + head->size;
+    }
+
+    inline void JsonArena::release() {
+        auto chunk = head;
+        while (chunk) {
+            auto next = chunk->next;
+            std::free(chunk);
+            chunk = next;
+        }
+        head = nullptr;
+        cursor = nullptr;
+        end = nullptr;
+        blocks = 0;
+    }
+
+    inline size_t JsonArena::capacity() const {
+        size_t result = 0;
+        for (auto chunk = head; chunk; chunk = chunk->next) {
+            result += chunk->size;
+        }
+        return result;
+    }
+
+    //JsonArenaAllocator class member function
+
+    template <typename T>
+    inline JsonArenaAllocator<T>::JsonArenaAllocator(JsonArena *a) : arena(a) {}
+
+    template <typename T>
+    template <typename U>
+    inline JsonArenaAllocator<T>::JsonArenaAllocator(const JsonArenaAllocator<U> &other) : arena(other.arena) {}
+
+    //node buffers are handed out through a char allocator, so every block is pointer aligned
+    template <typename T>
+    inline T *JsonArenaAllocator<T>::allocate(const size_t& num) {
+        if (arena) {
+            ++arena->blocks;
+            return static_cast<T *>(arena->allocate(num * sizeof(T), alignof(T) > alignof(void *) ? alignof(T) : alignof(void *)));
+        }
+        return static_cast<T *>(::operator new(num * sizeof(T)));
+    }
+
+    template <typename T>
+    inline void JsonArenaAllocator<T>::deallocate(T *ptr, const size_t&) {
+        if (!arena) {
+            ::operator delete(ptr);
+        }
+        else {
+            --arena->blocks;
+        }
+    }
+
+    template <typename T>
+    template <typename U>
+    inline bool JsonArenaAllocator<T>::operator==(const JsonArenaAllocator<U> &other) const {
+        return arena == other.arena;
+    }
+
+    template <typename T>
+    template <typename U>
+    inline bool JsonArenaAllocator<T>::operator!=(const JsonArenaAllocator<U> &other) const {
+        return arena != other.arena;
+    }
+}
@@ -1,23 +1,38 @@
 #pragma once
-#include "JsonCore.h"
 #include "Utility.h"
+#include "JsonCore.h"
+#include "JsonControlGroup.h"
+#include "JsonHashing.h"
 
 namespace Jsoncpp {
+    //JsonObjectHeader class
+    //sits in front of the control bytes of every JsonObject table
+    struct JsonObjectHeader {
+        size_t capacity;
+        size_t growth_left;
+    };
+
 //Json class
+//16 bytes: the payload word, a count (characters, elements or entries), the string flags and the type. Buffers a node
+//owns start right after a JsonBlock holding their allocator, so a node with nothing to free carries no allocator.
+//Copying a node only shares its buffer, which every mutating member detaches first by copying that one level, so an
+//edit clones the path from the root down to it. A container that handed out a mutable reference to a child is copied
+//one level right away instead, so writes through that reference never reach the copy
 template <typename Alloc = std::allocator<char>>
     struct Json {
         using allocator_type = Alloc;
         using alloc_traits = std::allocator_traits<allocator_type>;
-        using alloc_propagate_c = typename alloc_traits::propagate_on_container_copy_assignment;
-        using alloc_propagate_m = typename alloc_traits::propagate_on_container_move_assignment;
+        using block_type = JsonBlock<allocator_type>;
 
-        JsonType type;
         BasicJSON json;
-        allocator_type allocator_object;
+        uint32_t count;
+        char inline_tail[2];
+        uint8_t flags;
+        JsonType type;
 
 
-        Json() = default;
-        Json(const JsonType &t);
+        Json();
+        Json(const JsonType &t, const allocator_type &allocator = allocator_type());
         Json(const Json &other);
         Json(Json&& other) noexcept;
         Json& operator= (const Json& other);
@@ -25,6 +40,22 @@ template <typename Alloc = std::allocator<char>>
         ~Json();
         bool operator== (const Json& other) const;
         bool operator!=(const Json &other) const;
+        size_t hash() const;
+        size_t cachedHash() const;
+        bool ownsBlock() const;
+        allocator_type allocator() const;
+        void shallowCopy(const Json &other);
+        void share();
+        bool isShared() const;
+        void detach();
+        void leak();
+        bool isLeaked() const;
+        void cloneBlock(const Json &source);
+        void releaseDynamicContainer();
+        static char_ptr allocateBlock(const allocator_type& allocator, const size_t& bytes);
+        static void deallocateBlock(char_ptr payload);
+        static block_type *block(const_char_ptr payload);
+        static bool isDefaultAllocator(const allocator_type& allocator);
 };
 
     //JsonString class
@@ -32,38 +63,75 @@ template <typename Alloc = std::allocator<char>>
     struct JsonString : public Json<Alloc> {
         JsonString();
         template <typename Ptr>
-        JsonString(Ptr ptr);
+        JsonString(Ptr ptr, const Alloc& allocator = Alloc());
         template <typename Ptr>
-        JsonString(Ptr ptr, const size_t& l);
+        JsonString(Ptr ptr, const size_t& l, const Alloc& allocator = Alloc());
+        template <typename Ptr>
+        JsonString(const JsonBorrow& tag, Ptr ptr, const size_t& l, const Alloc& allocator = Alloc());
+        JsonString(const JsonInternedKey& key);
         size_t length() const;
+        const_char_ptr data() const;
+        bool isInline() const;
+        bool isBorrowed() const;
+        bool isInterned() const;
+        void own(const Alloc& allocator = Alloc());
+        void assign(const_char_ptr ptr, const size_t& l, const Alloc& allocator);
         bool operator==(const JsonString<Alloc> &other) const;
     };
 
     //JsonArray class
+    //count elements in a block sized in whole elements, the capacity is read back from the block. JsonArray(num) and
+    //reserve give room for num elements up front, pushBack and emplaceBack double the capacity when it runs out
     template <typename Alloc = std::allocator<char>>
     struct JsonArray: public Json<Alloc> {
+        static constexpr size_t min_capacity = 4;
+
         JsonArray();
-        JsonArray(const size_t& num);
+        JsonArray(const size_t& num, const Alloc& allocator = Alloc());
         const Json<Alloc> &operator[](const size_t &index) const;
         Json<Alloc> &operator[](const size_t &index);
         size_t length() const;
+        size_t capacity() const;
+        void reserve(const size_t& num);
+        void shrinkToFit();
         template <typename T>
         std::enable_if_t<std::is_convertible_v<T, Json<Alloc>>> pushBack(T &&element);
+        template <typename... Args>
+        Json<Alloc> &emplaceBack(Args&&... args);
+        template <typename... Args>
+        Json<Alloc> &emplace(const size_t& index, Args&&... args);
+        template <typename... Args>
+        Json<Alloc> &constructBack(Args&&... args);
+        template <typename... Args>
+        Json<Alloc> &constructAt(const size_t& index, Args&&... args);
+        bool erase(const size_t& index);
+        void append(Json<Alloc> *elements, const size_t& num);
         bool operator==(const JsonArray<Alloc> &other) const;
+
+        void reallocate(const size_t& num);
     };
 
     //hash
+    //seeded per process, see hashSeed. Interned keys carry the hash computed when they were added to their dictionary,
+    //any other node hashes its content with Json::hash
     template <typename Alloc>
-    struct JsonHash : public std::hash<std::string_view> {
+    struct JsonHash {
+        //keys hashed ahead of time go through here, so they always agree with the hash of the stored key
+        size_t operator()(const std::string_view& s) const {
+            return hashBytes(s.data(), s.size(), hashSeed());
+        }
+
         size_t operator()(const Json<Alloc>& j) const {
             switch (j.type) {
-                case JsonType::Array:
-                case JsonType::Object:
                 case JsonType::String: {
-                    return reinterpret_cast<const hash<std::string_view>*>(this)->operator()(std::string_view(j.json.dynamic_container.pointer, j.json.dynamic_container.length));
+                    auto &s = *reinterpret_cast<const JsonString<Alloc> *>(&j);
+                    if (s.isInterned()) {
+                        return JsonInternedKey::of(s.data())->hash;
+                    }
+                    return operator()(std::string_view(s.data(), s.length()));
                 }
                 default: {
-                    return j.json.integer;
+                    return j.hash();
                 }
             }
         }
@@ -74,26 +142,85 @@ template <typename Alloc = std::allocator<char>>
     struct JsonKeyValuePair {
         JsonString<Alloc> key;
         Json<Alloc> value;
-        bool active = false;
 
         bool operator==(const JsonKeyValuePair<Alloc>& other) const {
-            return key == other.key & value == other.value & active == other.active;
+            return key == other.key && value == other.value;
         }
     };
 
+    //a node is its 16 bytes, the buffers it owns stay where they are when it is copied somewhere else
+    template <typename Alloc>
+    struct is_trivially_relocatable<Json<Alloc>> : std::true_type {};
+
+    template <typename Alloc>
+    struct is_trivially_relocatable<JsonKeyValuePair<Alloc>> : std::true_type {};
+
+    //JsonObjectIterator class
+    //walks the full slots of a JsonObject table in slot order
+    template <typename Slot>
+    struct JsonObjectIterator {
+        const ctrl_t *control;
+        Slot *slots;
+        size_t index;
+        size_t capacity;
+
+        JsonObjectIterator(const ctrl_t *c, Slot *s, const size_t& i, const size_t& cap);
+        Slot &operator*() const;
+        Slot *operator->() const;
+        JsonObjectIterator &operator++();
+        bool operator==(const JsonObjectIterator &other) const;
+        bool operator!=(const JsonObjectIterator &other) const;
+    };
+
     //JsonObject class
+    //open addressing table in one allocation: [JsonObjectHeader][capacity + 16 control bytes][slots]. Capacity is
+    //always 2^k - 1 and probing goes a group of 16 control bytes at a time, the 15 bytes after the sentinel copy the
+    //first ones so a group never has to wrap. count is the number of entries
     template <typename Alloc = std::allocator<char>>
     struct JsonObject : public  Json<Alloc> {
+        using slot_type = JsonKeyValuePair<Alloc>;
+        using iterator = JsonObjectIterator<slot_type>;
+        using const_iterator = JsonObjectIterator<const slot_type>;
         static constexpr JsonHash<Alloc> hasher{};
-        
-        JsonObject(const size_t &num = 32);
+        static constexpr size_t npos = SIZE_MAX;
+
+        JsonObject(const size_t &num = 0, const Alloc& allocator = Alloc());
         Json<Alloc>* at(const JsonString<Alloc> &key);
+        const Json<Alloc>* at(const JsonString<Alloc> &key) const;
+        Json<Alloc>* at(const std::string_view& key, const size_t& hash_value);
+        const Json<Alloc>* at(const std::string_view& key, const size_t& hash_value) const;
         Json<Alloc> &operator[](const JsonString<Alloc> &key);
         Json<Alloc> &operator[](JsonString<Alloc> &&key);
+        template <typename K>
+        Json<Alloc> &findOrInsert(K &&key);
         template <typename K, typename V>
         std::enable_if_t<std::is_convertible_v<K, JsonString<Alloc>> && std::is_convertible_v<V, Json<Alloc>>> insert(K &&key, V &&value);
+        bool erase(const JsonString<Alloc> &key);
         bool rehash(const size_t& num);
+        void reserve(const size_t& num);
+        size_t length() const;
+        size_t capacity() const;
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
         bool operator==(const JsonObject<Alloc> &other) const;
+
+        size_t find(const JsonString<Alloc> &key, const size_t& hash_value) const;
+        size_t find(const std::string_view& key, const size_t& hash_value) const;
+        size_t findFirstNonFull(const size_t& hash_value) const;
+        size_t prepareInsert(const size_t& hash_value);
+        void allocateTable(const size_t& capacity, const Alloc& allocator);
+        void setControl(const size_t& index, const ctrl_t& h);
+        JsonObjectHeader *header() const;
+        ctrl_t *control() const;
+        slot_type *slots() const;
+
+        static size_t growthFor(const size_t& capacity);
+        static size_t capacityFor(const size_t& num);
+        static size_t slotOffset(const size_t& capacity);
+        static void copyTable(Json<Alloc>& des, const Json<Alloc>& src, const Alloc& allocator);
+        static void destroyTable(Json<Alloc>& json);
     };
 
     //JsonDecimal class
@@ -127,93 +254,228 @@ template <typename Alloc = std::allocator<char>>
     //Json class member function
 
     template <typename Alloc>
-    inline Json<Alloc>::Json(const Json &other)
-        : type(other.type), allocator_object(alloc_traits::select_on_container_copy_construction(other.allocator_object)), json(other.json) {
-        switch (type) {
-        case JsonType::String: {
-            auto &dc = json.dynamic_container;
-            dc.pointer = alloc_traits::allocate(allocator_object, dc.size);
-            copyPtrElement(dc.pointer, other.json.dynamic_container.pointer, dc.size);
-            break;
-            }
-            case JsonType::Array: {
-                auto &dc = json.dynamic_container;
-                dc.pointer = alloc_traits::allocate(allocator_object, dc.size);
-                copyPtrElement(reinterpret_cast<Json<Alloc> *>(dc.pointer), reinterpret_cast<Json<Alloc> *>(other.json.dynamic_container.pointer), dc.length);
-                break;
-            }
-            case JsonType::Object: {
-                auto &dc = json.dynamic_container;
-                dc.pointer = alloc_traits::allocate(allocator_object, dc.size);
-                copyPtrElement(reinterpret_cast<JsonKeyValuePair<Alloc> *>(dc.pointer), reinterpret_cast<JsonKeyValuePair<Alloc> *>(other.json.dynamic_container.pointer), dc.length);
-                break;
-            }
+    inline Json<Alloc>::Json()
+    : json({}), count(0), inline_tail{}, flags(0), type(JsonType::Null) {}
+
+    template <typename Alloc>
+    inline Json<Alloc>::Json(const Json &other) {
+        shallowCopy(other);
+        if (other.isLeaked()) {
+            cloneBlock(other);
+        }
+        else {
+            share();
         }
     }
 
     template <typename Alloc>
-    inline Json<Alloc>::Json(Json&& other) noexcept 
-    : type(other.type), allocator_object(std::move(other.allocator_object)), json(other.json) {
-        other.json.dynamic_container.pointer = nullptr;
+    inline Json<Alloc>::Json(Json&& other) noexcept {
+        shallowCopy(other);
+        other.type = JsonType::Null;
+        other.flags = 0;
+        other.json.pointer = nullptr;
     }
 
+    //an empty container still needs a block to remember a non default allocator
     template <typename Alloc>
-    inline Json<Alloc>::Json(const JsonType& t)
-    : type(t), allocator_object({}), json({}) {}
+    inline Json<Alloc>::Json(const JsonType& t, const allocator_type& allocator)
+    : json({}), count(0), inline_tail{}, flags(0), type(t) {
+        if (isDefaultAllocator(allocator)) {
+            return;
+        }
+        if (type == JsonType::Array) {
+            json.pointer = allocateBlock(allocator, 0);
+        }
+        else if (type == JsonType::Object) {
+            reinterpret_cast<JsonObject<Alloc> *>(this)->allocateTable(0, allocator);
+        }
+    }
 
+    //other is shared before the old buffer is let go, which may be the one holding other
     template <typename Alloc>
     Json<Alloc>& Json<Alloc>::operator=(const Json& other) {
         if (this == &other)
         {
             return *this;
         }
-        auto &dc = json.dynamic_container;
-        alloc_traits::deallocate(allocator_object, dc.pointer, dc.size);
-        if (alloc_propagate_c::value)
-        {
-            allocator_object = other.allocator_object;
+        Json<Alloc> temp(other);
+        releaseDynamicContainer();
+        shallowCopy(temp);
+        temp.type = JsonType::Null;
+        return *this;
+    }
+
+    template <typename Alloc>
+    Json<Alloc>& Json<Alloc>::operator=(Json&& other) noexcept {
+        if (this == &other) {
+            return *this;
         }
+        releaseDynamicContainer();
+        shallowCopy(other);
+        other.type = JsonType::Null;
+        other.flags = 0;
+        other.json.pointer = nullptr;
+        return *this;
+    }
+
+    template <typename Alloc>
+    inline Json<Alloc>::~Json() {
+        releaseDynamicContainer();
+    }
+
+    template <typename Alloc>
+    inline bool Json<Alloc>::ownsBlock() const {
+        switch (type) {
+            case JsonType::String: {
+                return !(flags & (json_inline_string | json_borrowed_string | json_interned_string)) && json.pointer;
+            }
+            case JsonType::Array:
+            case JsonType::Object: {
+                return json.pointer;
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    //the allocator of the node's own block, a node without one reports the default allocator
+    template <typename Alloc>
+    inline typename Json<Alloc>::allocator_type Json<Alloc>::allocator() const {
+        if (ownsBlock()) {
+            return block(json.pointer)->allocator;
+        }
+        return allocator_type();
+    }
+
+    //copies the 16 bytes of the node, buffers stay shared
+    template <typename Alloc>
+    inline void Json<Alloc>::shallowCopy(const Json& other) {
+        json = other.json;
+        count = other.count;
+        inline_tail[0] = other.inline_tail[0];
+        inline_tail[1] = other.inline_tail[1];
+        flags = other.flags;
         type = other.type;
-        auto &odc = other.json.dynamic_container;
-        dc.length = odc.length;
-        dc.size = odc.size;
-        dc.pointer = alloc_traits::allocate(allocator_object, dc.size);
+    }
+
+    //expects the node to hold a shallow copy, which becomes one more owner of the buffer
+    template <typename Alloc>
+    inline void Json<Alloc>::share() {
+        if (ownsBlock()) {
+            block(json.pointer)->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename Alloc>
+    inline bool Json<Alloc>::isShared() const {
+        return ownsBlock() && block(json.pointer)->references.load(std::memory_order_acquire) != 1;
+    }
+
+    //gives the node a buffer of its own, elements and entries are copied as nodes and so stay shared one level down.
+    //Every mutating member goes through here, so this is also where the cached hash is dropped
+    template <typename Alloc>
+    void Json<Alloc>::detach() {
+        if (!isShared()) {
+            if (ownsBlock()) {
+                block(json.pointer)->hash.store(0, std::memory_order_relaxed);
+            }
+            return;
+        }
+        Json<Alloc> shared;
+        shared.shallowCopy(*this);
+        cloneBlock(shared);
+    }
+
+    //detaches and marks the buffer as reachable through a mutable reference, done by every member handing one out
+    template <typename Alloc>
+    inline void Json<Alloc>::leak() {
+        detach();
+        if (ownsBlock()) {
+            block(json.pointer)->leaked = true;
+        }
+    }
+
+    template <typename Alloc>
+    inline bool Json<Alloc>::isLeaked() const {
+        return ownsBlock() && block(json.pointer)->leaked;
+    }
+
+    //points the node, already a shallow copy of source, at a fresh copy of the buffer of source. Elements and entries
+    //are copied as nodes and so stay shared one level down
+    template <typename Alloc>
+    void Json<Alloc>::cloneBlock(const Json<Alloc>& source) {
+        auto allocator = block(source.json.pointer)->allocator;
         switch (type) {
             case JsonType::String: {
-                copyPtrElement(dc.pointer, odc.pointer, dc.size);
+                json.pointer = allocateBlock(allocator, count);
+                std::memcpy(json.pointer, source.json.pointer, count);
                 break;
             }
             case JsonType::Array: {
-                copyPtrElement(reinterpret_cast<Json<Alloc> *>(dc.pointer), reinterpret_cast<Json<Alloc> *>(odc.pointer), dc.length);
+                json.pointer = allocateBlock(allocator, count * sizeof(Json<Alloc>));
+                constructCopyPtrElement(reinterpret_cast<Json<Alloc> *>(json.pointer), reinterpret_cast<const Json<Alloc> *>(source.json.pointer), count);
                 break;
             }
             case JsonType::Object: {
-                copyPtrElement(reinterpret_cast<JsonKeyValuePair<Alloc> *>(dc.pointer), reinterpret_cast<JsonKeyValuePair<Alloc> *>(odc.pointer), dc.length);
+                JsonObject<Alloc>::copyTable(*this, source, allocator);
+                break;
+            }
+            default: {
                 break;
             }
         }
-        return *this;
     }
 
+    //the last owner destroys the elements or entries and frees the buffer
     template <typename Alloc>
-    Json<Alloc>& Json<Alloc>::operator=(Json&& other) noexcept {
-        auto &dc = json.dynamic_container;
-        if (type == JsonType::Array | type == JsonType::Object | type == JsonType::String){
-            alloc_traits::deallocate(allocator_object, dc.pointer, dc.size);
+    void Json<Alloc>::releaseDynamicContainer() {
+        if (!ownsBlock()) {
+            return;
         }
-        type = other.type;
-        dc = other.json.dynamic_container;
-        other.json.dynamic_container.pointer = nullptr;
-        if (alloc_propagate_m::value) {
-            allocator_object = std::move(other.allocator_object);
+        if (block(json.pointer)->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if (type == JsonType::Array) {
+                destroyPtrElement(reinterpret_cast<Json<Alloc> *>(json.pointer), count);
+            }
+            else if (type == JsonType::Object) {
+                JsonObject<Alloc>::destroyTable(*this);
+            }
+            deallocateBlock(json.pointer);
         }
-        return *this;
+        json.pointer = nullptr;
     }
 
+    //returns the payload, the block header goes in front of it
     template <typename Alloc>
-    inline Json<Alloc>::~Json() {
-        if (type == JsonType::String | type == JsonType::Array | type == JsonType::Object) {
-            alloc_traits::deallocate(allocator_object, json.dynamic_container.pointer, json.dynamic_container.size);
+    char_ptr Json<Alloc>::allocateBlock(const allocator_type& allocator, const size_t& bytes) {
+        allocator_type temp(allocator);
+        size_t size = sizeof(block_type) + bytes;
+        char_ptr raw = alloc_traits::allocate(temp, size);
+        new (raw) block_type{allocator, false, {1}, size, {0}};
+        return raw + sizeof(block_type);
+    }
+
+    template <typename Alloc>
+    void Json<Alloc>::deallocateBlock(char_ptr payload) {
+        auto header = block(payload);
+        allocator_type temp(std::move(header->allocator));
+        size_t size = header->size;
+        header->~block_type();
+        alloc_traits::deallocate(temp, reinterpret_cast<char_ptr>(header), size);
+    }
+
+    template <typename Alloc>
+    inline typename Json<Alloc>::block_type* Json<Alloc>::block(const_char_ptr payload) {
+        return reinterpret_cast<block_type *>(const_cast<char_ptr>(payload) - sizeof(block_type));
+    }
+
+    template <typename Alloc>
+    inline bool Json<Alloc>::isDefaultAllocator(const allocator_type& allocator) {
+        if constexpr (alloc_traits::is_always_equal::value) {
+            return true;
+        }
+        else {
+            return allocator == allocator_type();
         }
     }
 
@@ -222,9 +484,16 @@ template <typename Alloc = std::allocator<char>>
         if (this == &other) {
             return true;
         }
-        auto &dc = json.dynamic_container;
-        auto &odc = other.json.dynamic_container;
-        if ((type == other.type) && (allocator_object == other.allocator_object)) {
+        if (type == other.type && ownsBlock() && json.pointer == other.json.pointer && count == other.count) {
+            return true;
+        }
+        //hashes computed before settle most unequal pairs without looking at the content
+        if (type == other.type) {
+            auto hash_value = cachedHash();
+            auto other_hash = other.cachedHash();
+            if (hash_value && other_hash && hash_value != other_hash) {
+                return false;
+            }
             switch (type) {
                 case JsonType::Array: {
                     return reinterpret_cast<const JsonArray<Alloc> *>(this)->operator==(*reinterpret_cast<const JsonArray<Alloc> *>(&other));
@@ -257,46 +526,173 @@ template <typename Alloc = std::allocator<char>>
         return !(*this == other);
     }
 
+    //content hash, equal values hash equal. Strings hash like JsonHash, elements are combined in order and entries are
+    //added up so slot order does not matter. Strings, arrays and objects with a buffer keep the result in the block
+    //header until they are changed through a mutating member. A leaked block can change behind its back through a child
+    //reference, so its hash is never kept
+    template <typename Alloc>
+    size_t Json<Alloc>::hash() const {
+        uint64_t seed = hashSeed() ^ static_cast<uint64_t>(type);
+        switch (type) {
+            case JsonType::Null: {
+                return hashInteger(0, seed);
+            }
+            case JsonType::Boolean: {
+                return hashInteger(json.boolean, seed);
+            }
+            case JsonType::Integer: {
+                return hashInteger(json.integer, seed);
+            }
+            case JsonType::Decimal: {
+                //0.0 and -0.0 compare equal
+                double value = json.decimal == 0 ? 0.0 : json.decimal;
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return hashInteger(bits, seed);
+            }
+            default: {
+                break;
+            }
+        }
+        size_t result = cachedHash();
+        if (result) {
+            return result;
+        }
+        if (type == JsonType::String) {
+            result = JsonHash<Alloc>()(*this);
+        }
+        else if (type == JsonType::Array) {
+            result = seed;
+            auto elements = reinterpret_cast<const Json<Alloc> *>(json.pointer);
+            for (size_t k = 0; k < count; ++k) {
+                result = hashMix(result ^ elements[k].hash(), hash_secret[2]);
+            }
+        }
+        else {
+            result = seed + count;
+            for (auto &slot : *reinterpret_cast<const JsonObject<Alloc> *>(this)) {
+                result += hashMix(JsonHash<Alloc>()(slot.key) ^ hash_secret[2], slot.value.hash() ^ hash_secret[3]);
+            }
+        }
+        if (!result) {
+            result = 1;
+        }
+        if (ownsBlock() && !block(json.pointer)->leaked) {
+            block(json.pointer)->hash.store(result, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    //0 when the hash was not computed since the last change, or the node has no buffer to keep it in or a leaked one
+    template <typename Alloc>
+    inline size_t Json<Alloc>::cachedHash() const {
+        return ownsBlock() ? block(json.pointer)->hash.load(std::memory_order_relaxed) : 0;
+    }
+
     //JsonString class member function
 
     template <typename Alloc>
-    inline JsonString<Alloc>::JsonString() : Json<Alloc>(JsonType::String) {}
+    inline JsonString<Alloc>::JsonString() : Json<Alloc>(JsonType::String) {
+        Json<Alloc>::flags = json_inline_string;
+    }
 
     template <typename Alloc>
     template <typename Ptr>
-    JsonString<Alloc>::JsonString(Ptr ptr) 
+    JsonString<Alloc>::JsonString(Ptr ptr, const Alloc& allocator) 
     : Json<Alloc>(JsonType::String) {
         static_assert(convertible_to_char_pointer<Ptr>);
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        dc.length = std::strlen(ptr);
-        dc.size = dc.length;
-        dc.pointer = Json<Alloc>::alloc_traits::allocate(Json<Alloc>::allocator_object, dc.size);
-        std::memcpy(dc.pointer, ptr, dc.size);
+        assign(ptr, std::strlen(ptr), allocator);
     }
 
     template <typename Alloc>
     template <typename Ptr>
-    JsonString<Alloc>::JsonString(Ptr ptr, const size_t& l) 
+    JsonString<Alloc>::JsonString(Ptr ptr, const size_t& l, const Alloc& allocator) 
     : Json<Alloc>(JsonType::String) {
         static_assert(convertible_to_char_pointer<Ptr>);
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        dc.length = l;
-        dc.size = l;
-        dc.pointer = Json<Alloc>::alloc_traits::allocate(Json<Alloc>::allocator_object, dc.size);
-        std::memcpy(dc.pointer, ptr, dc.size);
+        assign(ptr, l, allocator);
+    }
+
+    //the characters are not copied, ptr must outlive the string and every copy of it. Nothing is allocated, the
+    //allocator is only taken so the overloads line up
+    template <typename Alloc>
+    template <typename Ptr>
+    JsonString<Alloc>::JsonString(const JsonBorrow&, Ptr ptr, const size_t& l, const Alloc&)
+    : Json<Alloc>(JsonType::String) {
+        static_assert(convertible_to_char_pointer<Ptr>);
+        Json<Alloc>::flags = json_borrowed_string;
+        Json<Alloc>::count = l;
+        Json<Alloc>::json.pointer = const_cast<char_ptr>(static_cast<const_char_ptr>(ptr));
+    }
+
+    //points at the dictionary entry, which must outlive the string and every copy of it
+    template <typename Alloc>
+    inline JsonString<Alloc>::JsonString(const JsonInternedKey& key)
+    : Json<Alloc>(JsonType::String) {
+        Json<Alloc>::flags = json_interned_string;
+        Json<Alloc>::count = key.length;
+        Json<Alloc>::json.pointer = const_cast<char_ptr>(key.data());
+    }
+
+    //short strings go inline, longer ones get a block of exactly l bytes
+    template <typename Alloc>
+    void JsonString<Alloc>::assign(const_char_ptr ptr, const size_t& l, const Alloc& allocator) {
+        if (l <= max_inline_length) {
+            Json<Alloc>::flags = json_inline_string | static_cast<uint8_t>(l);
+            if (l) {
+                std::memcpy(&this->json, ptr, l);
+            }
+            return;
+        }
+        Json<Alloc>::flags = 0;
+        Json<Alloc>::count = l;
+        Json<Alloc>::json.pointer = Json<Alloc>::allocateBlock(allocator, l);
+        std::memcpy(Json<Alloc>::json.pointer, ptr, l);
     }
 
     template <typename Alloc>
     inline size_t JsonString<Alloc>::length() const {
-        return Json<Alloc>::json.dynamic_container.length;
+        if (isInline()) {
+            return Json<Alloc>::flags & json_inline_length_mask;
+        }
+        return Json<Alloc>::count;
+    }
+
+    template <typename Alloc>
+    inline const_char_ptr JsonString<Alloc>::data() const {
+        if (isInline()) {
+            return reinterpret_cast<const_char_ptr>(&this->json);
+        }
+        return Json<Alloc>::json.pointer;
+    }
+
+    template <typename Alloc>
+    inline bool JsonString<Alloc>::isInline() const {
+        return Json<Alloc>::flags & json_inline_string;
+    }
+
+    template <typename Alloc>
+    inline bool JsonString<Alloc>::isBorrowed() const {
+        return Json<Alloc>::flags & json_borrowed_string;
+    }
+
+    template <typename Alloc>
+    inline bool JsonString<Alloc>::isInterned() const {
+        return Json<Alloc>::flags & json_interned_string;
+    }
+
+    template <typename Alloc>
+    void JsonString<Alloc>::own(const Alloc& allocator) {
+        if (!isBorrowed()) {
+            return;
+        }
+        assign(Json<Alloc>::json.pointer, Json<Alloc>::count, allocator);
     }
 
     template <typename Alloc>
     inline bool JsonString<Alloc>::operator==(const JsonString<Alloc>& other) const {
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        auto &odc = other.json.dynamic_container;
-        if (dc.length == odc.length && dc.size == odc.size) {
-            return compare(dc.pointer, odc.pointer, dc.length);
+        auto l = length();
+        if (l == other.length()) {
+            return data() == other.data() || compare(data(), other.data(), l);
         }
         return false;
     }
@@ -307,195 +703,559 @@ template <typename Alloc = std::allocator<char>>
     inline JsonArray<Alloc>::JsonArray() : Json<Alloc>(JsonType::Array) {}
 
     template <typename Alloc>
-    JsonArray<Alloc>::JsonArray(const size_t& num)
-    : Json<Alloc>() {
-        Json<Alloc>::type = JsonType::Array;
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        dc.length = 0;
-        dc.size = num * sizeof(Json<Alloc>);
-        dc.pointer = Json<Alloc>::alloc_traits::allocate(Json<Alloc>::allocator_object, dc.size);
+    JsonArray<Alloc>::JsonArray(const size_t& num, const Alloc& allocator)
+    : Json<Alloc>(JsonType::Array) {
+        if (num || !Json<Alloc>::isDefaultAllocator(allocator)) {
+            Json<Alloc>::json.pointer = Json<Alloc>::allocateBlock(allocator, num * sizeof(Json<Alloc>));
+        }
     }
 
     template <typename Alloc>
     inline const Json<Alloc>& JsonArray<Alloc>::operator[](const size_t& index) const {
-        return reinterpret_cast<Json<Alloc> *>(Json<Alloc>::json.dynamic_container.pointer)[index];
+        return reinterpret_cast<Json<Alloc> *>(Json<Alloc>::json.pointer)[index];
     }
 
     template <typename Alloc>
     inline Json<Alloc>& JsonArray<Alloc>::operator[](const size_t& index) {
-        return reinterpret_cast<Json<Alloc> *>(Json<Alloc>::json.dynamic_container.pointer)[index];
+        Json<Alloc>::leak();
+        return reinterpret_cast<Json<Alloc> *>(Json<Alloc>::json.pointer)[index];
     }
 
     template <typename Alloc>
     inline size_t JsonArray<Alloc>::length() const {
-        return Json<Alloc>::json.dynamic_container.length;
+        return Json<Alloc>::count;
+    }
+
+    template <typename Alloc>
+    inline size_t JsonArray<Alloc>::capacity() const {
+        auto ptr = Json<Alloc>::json.pointer;
+        return ptr ? (Json<Alloc>::block(ptr)->size - sizeof(typename Json<Alloc>::block_type)) / sizeof(Json<Alloc>) : 0;
+    }
+
+    //moves the elements to a block with room for num of them, num is at least count
+    template <typename Alloc>
+    void JsonArray<Alloc>::reallocate(const size_t& num) {
+        auto &ptr = Json<Alloc>::json.pointer;
+        auto &count = Json<Alloc>::count;
+        auto allocator = Json<Alloc>::allocator();
+        char_ptr temp = nullptr;
+        if (num || !Json<Alloc>::isDefaultAllocator(allocator)) {
+            temp = Json<Alloc>::allocateBlock(allocator, num * sizeof(Json<Alloc>));
+            relocatePtrElement(reinterpret_cast<Json<Alloc> *>(temp), reinterpret_cast<Json<Alloc> *>(ptr), count);
+        }
+        if (ptr) {
+            Json<Alloc>::deallocateBlock(ptr);
+        }
+        ptr = temp;
+    }
+
+    template <typename Alloc>
+    inline void JsonArray<Alloc>::reserve(const size_t& num) {
+        Json<Alloc>::detach();
+        if (num > capacity()) {
+            reallocate(num);
+        }
+    }
+
+    template <typename Alloc>
+    inline void JsonArray<Alloc>::shrinkToFit() {
+        Json<Alloc>::detach();
+        if (capacity() > Json<Alloc>::count) {
+            reallocate(Json<Alloc>::count);
+        }
     }
 
     template <typename Alloc>
     template <typename T>
-    std::enable_if_t<std::is_convertible_v<T, Json<Alloc>>> JsonArray<Alloc>::pushBack(T &&element) {
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        if (dc.length * sizeof(Json<Alloc>) == dc.size) {
-            dc.size = ((dc.size == 0) ? 1 : (dc.size * 2));
-            char_ptr temp = Json<Alloc>::alloc_traits::allocate(Json<Alloc>::allocator_object, dc.size);
-            movePtrElement(reinterpret_cast<Json<Alloc> *>(temp), reinterpret_cast<Json<Alloc> *>(dc.pointer), dc.length);
-            Json<Alloc>::alloc_traits::deallocate(Json<Alloc>::allocator_object, dc.pointer, dc.length * sizeof(Json<Alloc>));
-            dc.pointer = temp;
+    inline std::enable_if_t<std::is_convertible_v<T, Json<Alloc>>> JsonArray<Alloc>::pushBack(T &&element) {
+        constructBack(std::forward<T>(element));
+    }
+
+    //the returned reference can be written through, so the block is marked leaked
+    template <typename Alloc>
+    template <typename... Args>
+    inline Json<Alloc>& JsonArray<Alloc>::emplaceBack(Args&&... args) {
+        auto &element = constructBack(std::forward<Args>(args)...);
+        Json<Alloc>::leak();
+        return element;
+    }
+
+    template <typename Alloc>
+    template <typename... Args>
+    inline Json<Alloc>& JsonArray<Alloc>::emplace(const size_t& index, Args&&... args) {
+        auto &element = constructAt(index, std::forward<Args>(args)...);
+        Json<Alloc>::leak();
+        return element;
+    }
+
+    //args are forwarded to a Json<Alloc> constructor and may refer to an element of this array, so when the block grows
+    //the new element is built before the old ones are moved out. Unlike emplaceBack the block is not marked leaked, for
+    //callers that drop the reference
+    template <typename Alloc>
+    template <typename... Args>
+    Json<Alloc>& JsonArray<Alloc>::constructBack(Args&&... args) {
+        Json<Alloc>::detach();
+        auto &ptr = Json<Alloc>::json.pointer;
+        auto &num = Json<Alloc>::count;
+        auto cap = capacity();
+        if (num < cap) {
+            new (reinterpret_cast<Json<Alloc> *>(ptr) + num) Json<Alloc>(std::forward<Args>(args)...);
+            return reinterpret_cast<Json<Alloc> *>(ptr)[num++];
+        }
+        char_ptr temp = Json<Alloc>::allocateBlock(Json<Alloc>::allocator(), (cap ? cap * 2 : min_capacity) * sizeof(Json<Alloc>));
+        new (reinterpret_cast<Json<Alloc> *>(temp) + num) Json<Alloc>(std::forward<Args>(args)...);
+        relocatePtrElement(reinterpret_cast<Json<Alloc> *>(temp), reinterpret_cast<Json<Alloc> *>(ptr), num);
+        if (ptr) {
+            Json<Alloc>::deallocateBlock(ptr);
+        }
+        ptr = temp;
+        return reinterpret_cast<Json<Alloc> *>(ptr)[num++];
+    }
+
+    //inserts before index, which is at most count. The elements after it are shifted up by relocation, so nothing is
+    //copied or moved one node at a time
+    template <typename Alloc>
+    template <typename... Args>
+    Json<Alloc>& JsonArray<Alloc>::constructAt(const size_t& index, Args&&... args) {
+        auto &num = Json<Alloc>::count;
+        if (index == num) {
+            return constructBack(std::forward<Args>(args)...);
+        }
+        Json<Alloc> temp(std::forward<Args>(args)...);
+        auto cap = capacity();
+        reserve(num < cap ? cap : cap * 2);
+        auto elements = reinterpret_cast<Json<Alloc> *>(Json<Alloc>::json.pointer);
+        std::memmove(static_cast<void *>(elements + index + 1), static_cast<const void *>(elements + index), (num - index) * sizeof(Json<Alloc>));
+        new (elements + index) Json<Alloc>(std::move(temp));
+        ++num;
+        return elements[index];
+    }
+
+    //the elements after index are shifted down by relocation, false when index is out of range
+    template <typename Alloc>
+    bool JsonArray<Alloc>::erase(const size_t& index) {
+        auto &num = Json<Alloc>::count;
+        if (index >= num) {
+            return false;
         }
-        reinterpret_cast<Json<Alloc> *>(dc.pointer)[dc.length++] = std::forward<T>(element);
-        for (size_t k = 0; k < dc.length; ++k) {
-            auto &temp = reinterpret_cast<Json<Alloc> *>(dc.pointer)[k];
+        Json<Alloc>::detach();
+        auto elements = reinterpret_cast<Json<Alloc> *>(Json<Alloc>::json.pointer);
+        elements[index].~Json<Alloc>();
+        std::memmove(static_cast<void *>(elements + index), static_cast<const void *>(elements + index + 1), (num - index - 1) * sizeof(Json<Alloc>));
+        --num;
+        return true;
+    }
+
+    //takes num nodes by relocation and leaves Null nodes in their place, which cost nothing to destroy
+    template <typename Alloc>
+    void JsonArray<Alloc>::append(Json<Alloc>* elements, const size_t& num) {
+        auto &count = Json<Alloc>::count;
+        reserve(count + num);
+        relocatePtrElement(reinterpret_cast<Json<Alloc> *>(Json<Alloc>::json.pointer) + count, elements, num);
+        for (size_t k = 0; k < num; ++k) {
+            new (elements + k) Json<Alloc>();
         }
+        count += num;
     }
 
     template <typename Alloc>
     inline bool JsonArray<Alloc>::operator==(const JsonArray<Alloc>& other) const {
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        auto &odc = other.json.dynamic_container;
-        if (dc.length == odc.length && dc.size == odc.size) {
-            return compare(reinterpret_cast<Json<Alloc>*>(dc.pointer), reinterpret_cast<Json<Alloc>*>(odc.pointer), dc.length);
+        if (Json<Alloc>::count == other.count) {
+            return compare(reinterpret_cast<Json<Alloc>*>(Json<Alloc>::json.pointer), reinterpret_cast<Json<Alloc>*>(other.json.pointer), Json<Alloc>::count);
         }
         return false;
     }
 
+    //JsonObjectIterator class member function
+    template <typename Slot>
+    inline JsonObjectIterator<Slot>::JsonObjectIterator(const ctrl_t *c, Slot *s, const size_t& i, const size_t& cap)
+    : control(c), slots(s), index(i), capacity(cap) {
+        while (index < capacity && control[index] < 0) {
+            ++index;
+        }
+    }
+
+    template <typename Slot>
+    inline Slot& JsonObjectIterator<Slot>::operator*() const {
+        return slots[index];
+    }
+
+    template <typename Slot>
+    inline Slot* JsonObjectIterator<Slot>::operator->() const {
+        return slots + index;
+    }
+
+    template <typename Slot>
+    inline JsonObjectIterator<Slot>& JsonObjectIterator<Slot>::operator++() {
+        ++index;
+        while (index < capacity && control[index] < 0) {
+            ++index;
+        }
+        return *this;
+    }
+
+    template <typename Slot>
+    inline bool JsonObjectIterator<Slot>::operator==(const JsonObjectIterator& other) const {
+        return index == other.index;
+    }
+
+    template <typename Slot>
+    inline bool JsonObjectIterator<Slot>::operator!=(const JsonObjectIterator& other) const {
+        return index != other.index;
+    }
+
     //JsonObject class member function
     template <typename Alloc>
-    JsonObject<Alloc>::JsonObject(const size_t &num) : Json<Alloc>(JsonType::Object) {
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        dc.length = num;
-        dc.size = num * sizeof(JsonKeyValuePair<Alloc>);
-        dc.pointer = Json<Alloc>::alloc_traits::allocate(Json<Alloc>::allocator_object, dc.size);
-        for (size_t k = 0; k < num; ++k) {
-            reinterpret_cast<JsonKeyValuePair<Alloc> *>(dc.pointer)[k].active = false;
+    JsonObject<Alloc>::JsonObject(const size_t &num, const Alloc& allocator) : Json<Alloc>(JsonType::Object) {
+        auto capacity = capacityFor(num);
+        if (capacity || !Json<Alloc>::isDefaultAllocator(allocator)) {
+            allocateTable(capacity, allocator);
         }
     }
 
     template <typename Alloc>
-    Json<Alloc>* JsonObject<Alloc>::at(const JsonString<Alloc>& key) {
-        size_t hash_value = hasher(key);
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        size_t start = hash_value % dc.length;
-        for (size_t k = start; k < dc.length; ++k) {
-            auto &slot = reinterpret_cast<JsonKeyValuePair<Alloc> *>(dc.pointer)[k];
-            if (slot.active && slot.key == key) {
-                return &slot.value;
-            }
+    inline size_t JsonObject<Alloc>::growthFor(const size_t& capacity) {
+        return capacity - capacity / 8;
+    }
+
+    template <typename Alloc>
+    inline size_t JsonObject<Alloc>::capacityFor(const size_t& num) {
+        if (!num) {
+            return 0;
+        }
+        size_t capacity = 1;
+        while (growthFor(capacity) < num) {
+            capacity = capacity * 2 + 1;
         }
-        return nullptr;
+        return capacity;
     }
 
     template <typename Alloc>
-    Json<Alloc>& JsonObject<Alloc>::operator[](const JsonString<Alloc>& key) {
-        size_t hash_value = hasher(key);
-    label:
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        size_t start = hash_value % dc.length;
-        for (size_t k = start; k < dc.length; ++k) {
-            auto &slot = reinterpret_cast<JsonKeyValuePair<Alloc> *>(dc.pointer)[k];
-            if (slot.active) {
-                if (slot.key == key) {
-                    return slot.value;
+    inline size_t JsonObject<Alloc>::slotOffset(const size_t& capacity) {
+        size_t offset = sizeof(JsonObjectHeader) + capacity + JsonControlGroup::width;
+        return (offset + alignof(slot_type) - 1) / alignof(slot_type) * alignof(slot_type);
+    }
+
+    template <typename Alloc>
+    inline JsonObjectHeader* JsonObject<Alloc>::header() const {
+        return reinterpret_cast<JsonObjectHeader *>(Json<Alloc>::json.pointer);
+    }
+
+    template <typename Alloc>
+    inline ctrl_t* JsonObject<Alloc>::control() const {
+        return reinterpret_cast<ctrl_t *>(Json<Alloc>::json.pointer + sizeof(JsonObjectHeader));
+    }
+
+    template <typename Alloc>
+    inline typename JsonObject<Alloc>::slot_type* JsonObject<Alloc>::slots() const {
+        return reinterpret_cast<slot_type *>(Json<Alloc>::json.pointer + slotOffset(header()->capacity));
+    }
+
+    template <typename Alloc>
+    inline size_t JsonObject<Alloc>::length() const {
+        return Json<Alloc>::count;
+    }
+
+    template <typename Alloc>
+    inline size_t JsonObject<Alloc>::capacity() const {
+        return Json<Alloc>::json.pointer ? header()->capacity : 0;
+    }
+
+    //writes the control byte and its copy past the sentinel
+    template <typename Alloc>
+    inline void JsonObject<Alloc>::setControl(const size_t& index, const ctrl_t& h) {
+        auto cap = capacity();
+        auto ctrl = control();
+        ctrl[index] = h;
+        ctrl[((index - (JsonControlGroup::width - 1)) & cap) + ((JsonControlGroup::width - 1) & cap)] = h;
+    }
+
+    template <typename Alloc>
+    inline size_t JsonObject<Alloc>::find(const JsonString<Alloc>& key, const size_t& hash_value) const {
+        return find(std::string_view(key.data(), key.length()), hash_value);
+    }
+
+    template <typename Alloc>
+    size_t JsonObject<Alloc>::find(const std::string_view& key, const size_t& hash_value) const {
+        auto cap = capacity();
+        if (!cap) {
+            return npos;
+        }
+        auto ctrl = control();
+        auto data_ptr = slots();
+        auto h2 = static_cast<ctrl_t>(hash_value & 0x7F);
+        size_t offset = (hash_value >> 7) & cap;
+        size_t step = 0;
+        while (true) {
+            JsonControlGroup group(ctrl + offset);
+            for (auto mask = group.match(h2); mask; mask &= mask - 1) {
+                size_t index = (offset + __builtin_ctz(mask)) & cap;
+                auto &slot_key = data_ptr[index].key;
+                //keys interned in the same dictionary share their characters and never get to the byte compare
+                if (slot_key.length() == key.size() && (slot_key.data() == key.data() || std::memcmp(slot_key.data(), key.data(), key.size()) == 0)) {
+                    return index;
                 }
             }
-            else {
-                slot.key = key;
-                slot.active = true;
-                return slot.value;
+            if (group.matchEmpty()) {
+                return npos;
             }
+            step += JsonControlGroup::width;
+            offset = (offset + step) & cap;
         }
-        rehash(2 * dc.length);
-        goto label;
     }
 
+    //tables smaller than a group are always probed from slot 0, so the first free bit is a real slot and not one of the
+    //empty bytes past the copied ones
     template <typename Alloc>
-    Json<Alloc>& JsonObject<Alloc>::operator[](JsonString<Alloc>&& key) {
-        JsonString<Alloc> moved_key = std::forward<JsonString<Alloc>>(key);
-        size_t hash_value = hasher(moved_key);
-    label:
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        size_t start = hash_value % dc.length;
-        for (size_t k = start; k < dc.length; ++k) {
-            auto &slot = reinterpret_cast<JsonKeyValuePair<Alloc> *>(dc.pointer)[k];
-            if (slot.active) {
-                if (slot.key == moved_key) {
-                    return slot.value;
-                }
-            }
-            else {
-                slot.key = std::move(moved_key);
-                slot.active = true;
-                return slot.value;
+    size_t JsonObject<Alloc>::findFirstNonFull(const size_t& hash_value) const {
+        auto cap = capacity();
+        auto ctrl = control();
+        size_t offset = cap < JsonControlGroup::width - 1 ? 0 : (hash_value >> 7) & cap;
+        size_t step = 0;
+        while (true) {
+            JsonControlGroup group(ctrl + offset);
+            auto mask = group.matchEmptyOrDeleted();
+            if (mask) {
+                return (offset + __builtin_ctz(mask)) & cap;
             }
+            step += JsonControlGroup::width;
+            offset = (offset + step) & cap;
         }
-        rehash(2 * dc.length);
-        goto label;
+    }
+
+    //claims a slot for a key that is not in the table yet, growing it first if needed
+    template <typename Alloc>
+    size_t JsonObject<Alloc>::prepareInsert(const size_t& hash_value) {
+        if (!capacity()) {
+            rehash(1);
+        }
+        auto target = findFirstNonFull(hash_value);
+        if (header()->growth_left == 0 && control()[target] != ctrl_deleted) {
+            auto cap = capacity();
+            //mostly tombstones, rebuilding at the same capacity is enough
+            rehash(length() * 2 <= growthFor(cap) ? cap : cap * 2 + 1);
+            target = findFirstNonFull(hash_value);
+        }
+        header()->growth_left -= (control()[target] == ctrl_empty);
+        setControl(target, static_cast<ctrl_t>(hash_value & 0x7F));
+        return target;
+    }
+
+    template <typename Alloc>
+    const Json<Alloc>* JsonObject<Alloc>::at(const JsonString<Alloc>& key) const {
+        auto index = find(key, hasher(key));
+        if (index == npos) {
+            return nullptr;
+        }
+        return &slots()[index].value;
+    }
+
+    template <typename Alloc>
+    Json<Alloc>* JsonObject<Alloc>::at(const JsonString<Alloc>& key) {
+        Json<Alloc>::leak();
+        return const_cast<Json<Alloc> *>(static_cast<const JsonObject<Alloc> *>(this)->at(key));
+    }
+
+    //lookup with a hash computed ahead of time through hasher, nothing is hashed or allocated
+    template <typename Alloc>
+    const Json<Alloc>* JsonObject<Alloc>::at(const std::string_view& key, const size_t& hash_value) const {
+        auto index = find(key, hash_value);
+        if (index == npos) {
+            return nullptr;
+        }
+        return &slots()[index].value;
+    }
+
+    template <typename Alloc>
+    Json<Alloc>* JsonObject<Alloc>::at(const std::string_view& key, const size_t& hash_value) {
+        Json<Alloc>::leak();
+        return const_cast<Json<Alloc> *>(static_cast<const JsonObject<Alloc> *>(this)->at(key, hash_value));
+    }
+
+    template <typename Alloc>
+    inline Json<Alloc>& JsonObject<Alloc>::operator[](const JsonString<Alloc>& key) {
+        auto &value = findOrInsert(key);
+        Json<Alloc>::leak();
+        return value;
+    }
+
+    template <typename Alloc>
+    inline Json<Alloc>& JsonObject<Alloc>::operator[](JsonString<Alloc>&& key) {
+        auto &value = findOrInsert(std::move(key));
+        Json<Alloc>::leak();
+        return value;
+    }
+
+    //operator[] without marking the block leaked, for callers that drop the reference. key is a JsonString<Alloc>
+    template <typename Alloc>
+    template <typename K>
+    Json<Alloc>& JsonObject<Alloc>::findOrInsert(K&& key) {
+        Json<Alloc>::detach();
+        size_t hash_value = hasher(key);
+        auto index = find(key, hash_value);
+        if (index == npos) {
+            index = prepareInsert(hash_value);
+            new (slots() + index) slot_type{std::forward<K>(key), Json<Alloc>()};
+            ++Json<Alloc>::count;
+        }
+        return slots()[index].value;
     }
 
     template <typename Alloc>
     template <typename K, typename V>
     inline std::enable_if_t<std::is_convertible_v<K, JsonString<Alloc>> && std::is_convertible_v<V, Json<Alloc>>> JsonObject<Alloc>::insert(K&& key, V&& value) {
-        this->operator[](std::forward<K>(key)) = std::forward<V>(value);
+        findOrInsert(JsonString<Alloc>(std::forward<K>(key))) = std::forward<V>(value);
+    }
+
+    //a slot can go back to empty when no probe sequence ever had to pass over it
+    template <typename Alloc>
+    bool JsonObject<Alloc>::erase(const JsonString<Alloc>& key) {
+        Json<Alloc>::detach();
+        auto index = find(key, hasher(key));
+        if (index == npos) {
+            return false;
+        }
+        slots()[index].~slot_type();
+        --Json<Alloc>::count;
+        auto cap = capacity();
+        auto empty_before = JsonControlGroup(control() + ((index - JsonControlGroup::width) & cap)).matchEmpty();
+        auto empty_after = JsonControlGroup(control() + index).matchEmpty();
+        bool was_never_full = empty_before && empty_after && static_cast<size_t>(__builtin_ctz(empty_after) + __builtin_clz(empty_before) - 16) < JsonControlGroup::width;
+        setControl(index, was_never_full ? ctrl_empty : ctrl_deleted);
+        header()->growth_left += was_never_full;
+        return true;
     }
 
+    //points the object at a fresh empty table, a capacity of 0 only keeps the header so the allocator is remembered
+    template <typename Alloc>
+    void JsonObject<Alloc>::allocateTable(const size_t& capacity, const Alloc& allocator) {
+        auto &ptr = Json<Alloc>::json.pointer;
+        ptr = Json<Alloc>::allocateBlock(allocator, capacity ? slotOffset(capacity) + capacity * sizeof(slot_type) : sizeof(JsonObjectHeader));
+        new (ptr) JsonObjectHeader{capacity, growthFor(capacity)};
+        if (capacity) {
+            std::memset(control(), ctrl_empty, capacity + JsonControlGroup::width);
+            control()[capacity] = ctrl_sentinel;
+        }
+    }
+
+    //rebuilds the table with at least num slots and room for every current entry
     template <typename Alloc>
     bool JsonObject<Alloc>::rehash(const size_t& num) {
-        char_ptr ptr = Json<Alloc>::alloc_traits::allocate(Json<Alloc>::allocator_object, num * sizeof(JsonKeyValuePair<Alloc>));
-        for (size_t k = 0; k < num; ++k) {
-            reinterpret_cast<JsonKeyValuePair<Alloc> *>(ptr)[k] = JsonKeyValuePair<Alloc>();
-        }
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        for (size_t k = 0; k < dc.length; ++k) {
-            auto &po = reinterpret_cast<JsonKeyValuePair<Alloc> *>(dc.pointer)[k];
-            if (po.active) {
-                size_t hash_loc = hasher(po.key) % num;
-                for (size_t c = hash_loc; c < num; ++c) {
-                    auto& new_po = reinterpret_cast<JsonKeyValuePair<Alloc> *>(ptr)[c];
-                    if (new_po.active) {
-                        continue;
-                    }
-                    new_po.active = true;
-                    new_po.key = std::move(po.key);
-                    new_po.value = std::move(po.value);
-                    po.active = false;
-                    goto label;
-                }
-                for (size_t c = 0; c < num; ++c) {
-                    auto& new_po = reinterpret_cast<JsonKeyValuePair<Alloc> *>(ptr)[c];
-                    if (new_po.active) {
-                        this->insert(std::move(new_po.key), std::move(new_po.value));
-                    }
-                }
-                Json<Alloc>::alloc_traits::deallocate(Json<Alloc>::allocator_object, ptr, num * sizeof(JsonKeyValuePair<Alloc>));
-                return false;
-            label:;
+        Json<Alloc>::detach();
+        auto &ptr = Json<Alloc>::json.pointer;
+        size_t new_capacity = capacityFor(length());
+        while (new_capacity < num) {
+            new_capacity = new_capacity * 2 + 1;
+        }
+        auto allocator = Json<Alloc>::allocator();
+        char_ptr old = ptr;
+        size_t old_capacity = capacity();
+        ctrl_t *old_control = old_capacity ? control() : nullptr;
+        slot_type *old_slots = old_capacity ? slots() : nullptr;
+        ptr = nullptr;
+        if (new_capacity || !Json<Alloc>::isDefaultAllocator(allocator)) {
+            allocateTable(new_capacity, allocator);
+            header()->growth_left -= length();
+        }
+        auto data_ptr = new_capacity ? slots() : nullptr;
+        for (size_t k = 0; k < old_capacity; ++k) {
+            if (old_control[k] >= 0) {
+                size_t hash_value = hasher(old_slots[k].key);
+                auto index = findFirstNonFull(hash_value);
+                setControl(index, static_cast<ctrl_t>(hash_value & 0x7F));
+                relocatePtrElement(data_ptr + index, old_slots + k, 1);
             }
         }
-        Json<Alloc>::alloc_traits::deallocate(Json<Alloc>::allocator_object, dc.pointer, dc.size);
-        dc.pointer = ptr;
-        dc.size = num * sizeof(JsonKeyValuePair<Alloc>);
-        dc.length = num;
+        if (old) {
+            Json<Alloc>::deallocateBlock(old);
+        }
         return true;
     }
 
+    template <typename Alloc>
+    inline void JsonObject<Alloc>::reserve(const size_t& num) {
+        auto cap = capacityFor(num);
+        if (cap > capacity()) {
+            rehash(cap);
+        }
+    }
+
+    template <typename Alloc>
+    inline typename JsonObject<Alloc>::iterator JsonObject<Alloc>::begin() {
+        Json<Alloc>::leak();
+        if (!capacity()) {
+            return iterator(nullptr, nullptr, 0, 0);
+        }
+        return iterator(control(), slots(), 0, capacity());
+    }
+
+    template <typename Alloc>
+    inline typename JsonObject<Alloc>::iterator JsonObject<Alloc>::end() {
+        return iterator(nullptr, nullptr, capacity(), capacity());
+    }
+
+    template <typename Alloc>
+    inline typename JsonObject<Alloc>::const_iterator JsonObject<Alloc>::begin() const {
+        if (!capacity()) {
+            return const_iterator(nullptr, nullptr, 0, 0);
+        }
+        return const_iterator(control(), slots(), 0, capacity());
+    }
+
+    template <typename Alloc>
+    inline typename JsonObject<Alloc>::const_iterator JsonObject<Alloc>::end() const {
+        return const_iterator(nullptr, nullptr, capacity(), capacity());
+    }
+
+    //expects des to hold a shallow copy of src
+    template <typename Alloc>
+    void JsonObject<Alloc>::copyTable(Json<Alloc>& des, const Json<Alloc>& src, const Alloc& allocator) {
+        auto &source = *reinterpret_cast<const JsonObject<Alloc> *>(&src);
+        auto &target = *reinterpret_cast<JsonObject<Alloc> *>(&des);
+        auto cap = source.capacity();
+        target.allocateTable(cap, allocator);
+        if (!cap) {
+            return;
+        }
+        std::memcpy(des.json.pointer, src.json.pointer, slotOffset(cap));
+        auto ctrl = source.control();
+        auto des_slots = target.slots();
+        auto src_slots = source.slots();
+        for (size_t k = 0; k < cap; ++k) {
+            if (ctrl[k] >= 0) {
+                new (des_slots + k) slot_type(src_slots[k]);
+            }
+        }
+    }
+
+    template <typename Alloc>
+    void JsonObject<Alloc>::destroyTable(Json<Alloc>& json) {
+        auto &object = *reinterpret_cast<JsonObject<Alloc> *>(&json);
+        auto cap = object.capacity();
+        if (!cap) {
+            return;
+        }
+        auto ctrl = object.control();
+        auto data_ptr = object.slots();
+        for (size_t k = 0; k < cap; ++k) {
+            if (ctrl[k] >= 0) {
+                data_ptr[k].~slot_type();
+            }
+        }
+    }
+
     template <typename Alloc>
     bool JsonObject<Alloc>::operator==(const JsonObject<Alloc>& other) const {
-        auto &dc = Json<Alloc>::json.dynamic_container;
-        auto &odc = other.json.dynamic_container;
-        if (dc.length == odc.length) {
-            auto data_ptr = reinterpret_cast<JsonKeyValuePair<Alloc> *>(dc.pointer);
-            for (size_t k = 0; k < dc.length; ++k) {
-                auto cur = data_ptr[k];
-                if (cur.active)
-                {
-                    auto other_value = other.at(cur.key);
-                    if (!other_value || (*other_value != cur.value)) {
-                        return false;
-                    }
-                }
+        if (length() != other.length()) {
+            return false;
+        }
+        for (auto &slot : *this) {
+            auto other_value = other.at(slot.key);
+            if (!other_value || (*other_value != slot.value)) {
+                return false;
             }
-            return true;
         }
-        return false;
+        return true;
     }
 
     //JsonDecimal class member function
@@ -539,4 +1299,38 @@ template <typename Alloc = std::allocator<char>>
     inline bool JsonNull<Alloc>::operator==(const JsonNull<Alloc>& other) const {
         return true;
     }
+
+    //turns every borrowed string of the tree, keys included, into an owning copy made with allocator
+    template <typename Alloc>
+    void ownStrings(Json<Alloc>& json, const Alloc& allocator = Alloc()) {
+        switch (json.type) {
+            case JsonType::String: {
+                reinterpret_cast<JsonString<Alloc> *>(&json)->own(allocator);
+                break;
+            }
+            case JsonType::Array: {
+                //walks the buffer directly, the references do not outlive the call so the block is not marked leaked
+                json.detach();
+                auto elements = reinterpret_cast<Json<Alloc> *>(json.json.pointer);
+                for (size_t k = 0; k < json.count; ++k) {
+                    ownStrings(elements[k], allocator);
+                }
+                break;
+            }
+            case JsonType::Object: {
+                json.detach();
+                for (auto &slot : *reinterpret_cast<const JsonObject<Alloc> *>(&json)) {
+                    auto &entry = const_cast<typename JsonObject<Alloc>::slot_type &>(slot);
+                    entry.key.own(allocator);
+                    ownStrings(entry.value, allocator);
+                }
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+
+    static_assert(sizeof(Json<>) == 16, "Json nodes are expected to stay 16 bytes");
 }
@@ -0,0 +1,77 @@
+#pragma once
+#include "Utility.h"
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Jsoncpp {
+    //one control byte per JsonObject slot: full slots hold the low 7 bits of the key hash, the rest are markers
+    using ctrl_t = signed char;
+    constexpr ctrl_t ctrl_empty = -128;
+    constexpr ctrl_t ctrl_deleted = -2;
+    constexpr ctrl_t ctrl_sentinel = -1;
+
+    //JsonControlGroup class
+    //16 control bytes probed at once, bit k of every mask describes byte k
+    struct JsonControlGroup {
+        static constexpr size_t width = 16;
+
+#if defined(__SSE2__)
+        __m128i ctrl;
+#else
+        ctrl_t ctrl[width];
+#endif
+
+        JsonControlGroup(const ctrl_t *pos);
+        uint32_t match(const ctrl_t& h2) const;
+        uint32_t matchEmpty() const;
+        uint32_t matchEmptyOrDeleted() const;
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //JsonControlGroup class member function
+
+#if defined(__SSE2__)
+    inline JsonControlGroup::JsonControlGroup(const ctrl_t *pos)
+    : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos))) {}
+
+    inline uint32_t JsonControlGroup::match(const ctrl_t& h2) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+    }
+
+    inline uint32_t JsonControlGroup::matchEmpty() const {
+        return match(ctrl_empty);
+    }
+
+    inline uint32_t JsonControlGroup::matchEmptyOrDeleted() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl)));
+    }
+#else
+    inline JsonControlGroup::JsonControlGroup(const ctrl_t *pos) {
+        std::memcpy(ctrl, pos, width);
+    }
+
+    inline uint32_t JsonControlGroup::match(const ctrl_t& h2) const {
+        uint32_t result = 0;
+        for (size_t k = 0; k < width; ++k) {
+            result |= uint32_t(ctrl[k] == h2) << k;
+        }
+        return result;
+    }
+
+    inline uint32_t JsonControlGroup::matchEmpty() const {
+        return match(ctrl_empty);
+    }
+
+    inline uint32_t JsonControlGroup::matchEmptyOrDeleted() const {
+        uint32_t result = 0;
+        for (size_t k = 0; k < width; ++k) {
+            result |= uint32_t(ctrl[k] < ctrl_sentinel) << k;
+        }
+        return result;
+    }
+#endif
+}
@@ -1,21 +1,58 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 
 namespace Jsoncpp {
-    struct BasicDynamicContainer {
-        char_ptr pointer;
+    //sits in front of every buffer a node owns, the allocator lives here instead of in each node. Copies of a node share
+    //the buffer, references counts them. hash caches the content hash of the node, 0 until it is computed. leaked is set
+    //once a mutable reference into the buffer has been handed out, such a buffer is cloned by copies instead of shared
+    template <typename Alloc>
+    struct JsonBlock {
+        Alloc allocator;
+        bool leaked;
+        std::atomic<uint32_t> references;
         size_t size;
-        size_t length;
+        std::atomic<size_t> hash;
+    };
+
+    //tag selecting the borrowing JsonString constructor
+    struct JsonBorrow {};
+    constexpr JsonBorrow json_borrow{};
+
+    //strings this short are stored in the node itself, over the payload word, the count and the spare bytes
+    constexpr size_t max_inline_length = 14;
+
+    //String node flags, an inline string keeps its length in the low bits
+    constexpr uint8_t json_inline_string = 0x80;
+    constexpr uint8_t json_borrowed_string = 0x40;
+    constexpr uint8_t json_interned_string = 0x20;
+    constexpr uint8_t json_inline_length_mask = 0x0F;
+
+    //JsonInternedKey class
+    //an entry of a JsonKeyDictionary, the characters follow it. An interned string points at the characters and finds
+    //its entry, hash included, right in front of them
+    struct JsonInternedKey {
+        size_t hash;
+        uint32_t id;
+        uint32_t length;
+
+        const_char_ptr data() const {
+            return reinterpret_cast<const_char_ptr>(this + 1);
+        }
+
+        static const JsonInternedKey *of(const_char_ptr data) {
+            return reinterpret_cast<const JsonInternedKey *>(data) - 1;
+        }
     };
 
     union BasicJSON {
-        BasicDynamicContainer dynamic_container;
+        char_ptr pointer;
         long integer;
         double decimal;
         bool boolean;
     };
 
-    enum class JsonType {
+    enum class JsonType : uint8_t {
         Null, Boolean, Integer, Decimal, String, Array, Object
     };
 }
-
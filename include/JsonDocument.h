@@ -0,0 +1,198 @@
+#pragma once
+#include "JsonArena.h"
+#include "JsonParser.h"
+#include "JsonMappedFile.h"
+
+namespace Jsoncpp {
+    //JsonDocument class
+    //every node and string of the tree is bump allocated from the document's arena, tearing the tree down drops whole
+    //chunks without running node destructors. Values stored into the tree must use allocator(), anything allocated
+    //elsewhere is not freed with the document. A document loaded from a file keeps the file mapped, so its strings can
+    //point into the mapping instead of being copied. Values copied out of the tree share its buffers and must not
+    //outlive the document, clear and parse keep an old tree alive while such a copy is around
+    struct JsonDocument {
+        using allocator_type = JsonArenaAllocator<char>;
+        using value_type = Json<allocator_type>;
+
+        //an earlier tree still shared with a value outside the document, together with the arena and file backing it
+        struct Retired {
+            std::unique_ptr<JsonArena> arena;
+            value_type *root_ptr;
+            JsonMappedFile file;
+        };
+
+        std::unique_ptr<JsonArena> arena;
+        value_type *root_ptr = nullptr;
+        JsonMappedFile file;
+        std::vector<Retired> retired;
+        size_t chunk_size;
+
+        JsonDocument(const size_t& chunk_size = JsonArena::default_chunk_size);
+        JsonDocument(const JsonDocument &other) = delete;
+        JsonDocument(JsonDocument &&other) noexcept;
+        JsonDocument &operator=(const JsonDocument &other) = delete;
+        JsonDocument &operator=(JsonDocument &&other) noexcept;
+        bool parse(const_char_ptr ptr, const size_t& size);
+        bool parse(const_char_ptr ptr, const size_t& size, size_t& error_position);
+        bool parse(const_char_ptr ptr, const size_t& size, const ParseOptions& options, size_t& error_position);
+        bool load(const char *path);
+        bool load(const char *path, size_t& error_position);
+        bool load(const char *path, const ParseOptions& options, size_t& error_position);
+        value_type &root();
+        const value_type &root() const;
+        allocator_type allocator() const;
+        void clear();
+        static bool isReferenced(const JsonArena& arena, const value_type& root);
+        static size_t ownedBlocks(const value_type& node);
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //JsonDocument class member function
+
+    inline JsonDocument::JsonDocument(const size_t& chunk_size)
+    : arena(new JsonArena(chunk_size)), chunk_size(chunk_size) {
+        clear();
+    }
+
+    //the moved from document is left without an arena or a tree, clear or parse give it new ones
+    inline JsonDocument::JsonDocument(JsonDocument&& other) noexcept
+    : arena(std::move(other.arena)), root_ptr(other.root_ptr), file(std::move(other.file)), retired(std::move(other.retired)), chunk_size(other.chunk_size) {
+        other.root_ptr = nullptr;
+    }
+
+    inline JsonDocument& JsonDocument::operator=(JsonDocument&& other) noexcept {
+        if (this != &other) {
+            arena = std::move(other.arena);
+            root_ptr = other.root_ptr;
+            file = std::move(other.file);
+            retired = std::move(other.retired);
+            chunk_size = other.chunk_size;
+            other.root_ptr = nullptr;
+        }
+        return *this;
+    }
+
+    inline bool JsonDocument::parse(const_char_ptr ptr, const size_t& size, const ParseOptions& options, size_t& error_position) {
+        clear();
+        file.close();
+        JsonParser<allocator_type> parser(ptr, size, allocator(), options);
+        if (parser.parse(*root_ptr)) {
+            return true;
+        }
+        error_position = parser.position;
+        return false;
+    }
+
+    inline bool JsonDocument::parse(const_char_ptr ptr, const size_t& size, size_t& error_position) {
+        return parse(ptr, size, ParseOptions(), error_position);
+    }
+
+    inline bool JsonDocument::parse(const_char_ptr ptr, const size_t& size) {
+        size_t error_position;
+        return parse(ptr, size, error_position);
+    }
+
+    //the mapping is only kept when the parse succeeds, error_position is file_error when the file cannot be read
+    inline bool JsonDocument::load(const char *path, const ParseOptions& options, size_t& error_position) {
+        JsonMappedFile mapped;
+        if (!mapped.open(path)) {
+            clear();
+            file.close();
+            error_position = file_error;
+            return false;
+        }
+        if (!parse(mapped.data, mapped.size, options, error_position)) {
+            return false;
+        }
+        file = std::move(mapped);
+        return true;
+    }
+
+    //strings are borrowed from the mapping unless they are escaped or short enough to be stored inline
+    inline bool JsonDocument::load(const char *path, size_t& error_position) {
+        ParseOptions options;
+        options.borrow_strings = true;
+        return load(path, options, error_position);
+    }
+
+    inline bool JsonDocument::load(const char *path) {
+        size_t error_position;
+        return load(path, error_position);
+    }
+
+    //a moved from document gets an empty tree on first use
+    inline JsonDocument::value_type& JsonDocument::root() {
+        if (!root_ptr) {
+            clear();
+        }
+        return *root_ptr;
+    }
+
+    inline const JsonDocument::value_type& JsonDocument::root() const {
+        static const value_type null_root;
+        return root_ptr ? *root_ptr : null_root;
+    }
+
+    //falls back to the global heap on a moved from document until it is given a new arena
+    inline JsonDocument::allocator_type JsonDocument::allocator() const {
+        return allocator_type(arena.get());
+    }
+
+    //the old tree is abandoned, not destroyed. Its arena is only reset when nothing outside the tree holds one of its
+    //buffers, otherwise it is set aside with the file until a later clear finds it unreferenced
+    inline void JsonDocument::clear() {
+        if (!arena) {
+            arena.reset(new JsonArena(chunk_size));
+        }
+        for (size_t k = retired.size(); k > 0; --k) {
+            if (!isReferenced(*retired[k - 1].arena, *retired[k - 1].root_ptr)) {
+                retired.erase(retired.begin() + (k - 1));
+            }
+        }
+        if (root_ptr && isReferenced(*arena, *root_ptr)) {
+            retired.push_back({std::move(arena), root_ptr, std::move(file)});
+            arena.reset(new JsonArena(chunk_size));
+        }
+        else {
+            arena->reset();
+        }
+        root_ptr = new (arena->allocate(sizeof(value_type), alignof(value_type))) value_type(JsonType::Null, allocator());
+    }
+
+    //a copy taken out of the tree either shares one of its buffers or holds a buffer of its own from the arena, which
+    //the tree does not reach
+    inline bool JsonDocument::isReferenced(const JsonArena& arena, const value_type& root) {
+        return ownedBlocks(root) != arena.blocks;
+    }
+
+    //buffers reachable from node, npos when one of them has another owner
+    inline size_t JsonDocument::ownedBlocks(const value_type& node) {
+        constexpr size_t npos = SIZE_MAX;
+        if (!node.ownsBlock()) {
+            return 0;
+        }
+        if (node.isShared()) {
+            return npos;
+        }
+        size_t result = 1;
+        if (node.type == JsonType::Array) {
+            auto elements = reinterpret_cast<const value_type *>(node.json.pointer);
+            for (size_t k = 0; k < node.count && result != npos; ++k) {
+                size_t child = ownedBlocks(elements[k]);
+                result = child == npos ? npos : result + child;
+            }
+        }
+        else if (node.type == JsonType::Object) {
+            for (auto &slot : *reinterpret_cast<const JsonObject<allocator_type> *>(&node)) {
+                size_t key = ownedBlocks(slot.key);
+                size_t value = ownedBlocks(slot.value);
+                if (key == npos || value == npos) {
+                    return npos;
+                }
+                result += key + value;
+            }
+        }
+        return result;
+    }
+}
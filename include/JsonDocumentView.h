@@ -0,0 +1,311 @@
+#pragma once
+#include "JsonParser.h"
+
+namespace Jsoncpp {
+    //JsonDocumentView class
+    //lazy cursor over raw JSON text: at() scans forward from the current value and skips everything it was not asked
+    //for, numbers and strings are only decoded by the as*() accessors. Skipped values are not validated, only what is
+    //actually read is. A default constructed view is the "not found" result, the text must outlive every view on it
+    struct JsonDocumentView {
+        const_char_ptr data = nullptr;
+        size_t size = 0;
+        size_t position = 0;
+
+        JsonDocumentView() = default;
+        JsonDocumentView(const_char_ptr ptr, const size_t& s);
+        JsonDocumentView(const_char_ptr ptr, const size_t& s, const size_t& po);
+        explicit operator bool() const;
+        JsonType type() const;
+        JsonDocumentView at(const std::string_view& key) const;
+        JsonDocumentView at(const size_t& index) const;
+        JsonDocumentView operator[](const std::string_view& key) const;
+        JsonDocumentView operator[](const size_t& index) const;
+        bool isNull() const;
+        bool isBoolean() const;
+        bool asBoolean() const;
+        long asInteger() const;
+        double asDecimal() const;
+        std::string asString() const;
+        std::string_view rawString() const;
+        std::string_view raw() const;
+        template <typename Alloc>
+        bool materialize(Json<Alloc>& json_ref) const;
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    inline size_t skipWhiteSpace(const_char_ptr data, const size_t& size, size_t position) {
+        while (position < size && isWhiteSpace(data[position])) {
+            ++position;
+        }
+        return position;
+    }
+
+    //position is at the opening quote, returns the position after the closing one or size + 1 if there is none, so a
+    //string cut off after an escaped quote is not taken for one ending at the last byte
+    inline size_t skipString(const_char_ptr data, const size_t& size, const size_t& position) {
+        size_t start = position + 1;
+        size_t cur = start;
+        while (cur < size) {
+            auto quote = static_cast<const_char_ptr>(std::memchr(data + cur, '"', size - cur));
+            if (!quote) {
+                return size + 1;
+            }
+            size_t end = quote - data;
+            size_t k = end;
+            while (k > start && data[k - 1] == '\\') {
+                --k;
+            }
+            if ((end - k) % 2 == 0) {
+                return end + 1;
+            }
+            cur = end + 1;
+        }
+        return size + 1;
+    }
+
+    //returns the position after the value starting at position, or size if it never ends. Brackets are only counted,
+    //a mismatched pair is left for whoever reads the value
+    inline size_t skipValue(const_char_ptr data, const size_t& size, size_t position) {
+        if (position >= size) {
+            return size;
+        }
+        switch (data[position]) {
+            case '"': {
+                size_t end = skipString(data, size, position);
+                return end > size ? size : end;
+            }
+            case '{':
+            case '[': {
+                size_t depth = 0;
+                while (position < size) {
+                    switch (data[position]) {
+                        case '"': {
+                            position = skipString(data, size, position);
+                            continue;
+                        }
+                        case '{':
+                        case '[': {
+                            ++depth;
+                            break;
+                        }
+                        case '}':
+                        case ']': {
+                            if (--depth == 0) {
+                                return position + 1;
+                            }
+                            break;
+                        }
+                        default: {
+                            break;
+                        }
+                    }
+                    ++position;
+                }
+                return size;
+            }
+            default: {
+                while (position < size && !isWhiteSpace(data[position]) && data[position] != ',' && data[position] != '}' && data[position] != ']') {
+                    ++position;
+                }
+                return position;
+            }
+        }
+    }
+
+    //compares the raw characters of a key, escapes included, with an already decoded key
+    inline bool rawKeyEquals(const_char_ptr raw, const size_t& length, const std::string_view& key) {
+        auto escape = std::memchr(raw, '\\', length);
+        if (!escape) {
+            return length == key.size() && std::memcmp(raw, key.data(), length) == 0;
+        }
+        size_t matched = 0;
+        char buffer[4];
+        for (size_t k = 0; k < length;) {
+            if (raw[k] != '\\') {
+                if (matched == key.size() || key[matched++] != raw[k++]) {
+                    return false;
+                }
+                continue;
+            }
+            size_t written;
+            auto consumed = decodeEscape(raw + k + 1, length - k - 1, buffer, written);
+            if (!consumed || key.size() - matched < written || std::memcmp(key.data() + matched, buffer, written) != 0) {
+                return false;
+            }
+            matched += written;
+            k += consumed + 1;
+        }
+        return matched == key.size();
+    }
+
+    //JsonDocumentView class member function
+
+    inline JsonDocumentView::JsonDocumentView(const_char_ptr ptr, const size_t& s)
+    : data(ptr), size(s), position(skipWhiteSpace(ptr, s, 0)) {
+        if (position == size) {
+            data = nullptr;
+        }
+    }
+
+    inline JsonDocumentView::JsonDocumentView(const_char_ptr ptr, const size_t& s, const size_t& po)
+    : data(ptr), size(s), position(po) {}
+
+    inline JsonDocumentView::operator bool() const {
+        return data;
+    }
+
+    //Null for the "not found" view too
+    inline JsonType JsonDocumentView::type() const {
+        if (!data || position >= size) {
+            return JsonType::Null;
+        }
+        switch (data[position]) {
+            case '{': return JsonType::Object;
+            case '[': return JsonType::Array;
+            case '"': return JsonType::String;
+            case 't':
+            case 'f': return JsonType::Boolean;
+            case 'n': return JsonType::Null;
+            default: {
+                size_t end = position;
+                bool is_decimal;
+                scanNumber(data, size, end, is_decimal);
+                return is_decimal ? JsonType::Decimal : JsonType::Integer;
+            }
+        }
+    }
+
+    inline JsonDocumentView JsonDocumentView::at(const std::string_view& key) const {
+        if (!data || data[position] != '{') {
+            return JsonDocumentView();
+        }
+        size_t po = skipWhiteSpace(data, size, position + 1);
+        while (po < size && data[po] == '"') {
+            size_t key_end = skipString(data, size, po);
+            if (key_end >= size) {
+                break;
+            }
+            size_t value = skipWhiteSpace(data, size, key_end);
+            if (value == size || data[value] != ':') {
+                break;
+            }
+            value = skipWhiteSpace(data, size, value + 1);
+            if (value == size) {
+                break;
+            }
+            if (rawKeyEquals(data + po + 1, key_end - po - 2, key)) {
+                return JsonDocumentView(data, size, value);
+            }
+            po = skipWhiteSpace(data, size, skipValue(data, size, value));
+            if (po == size || data[po] != ',') {
+                break;
+            }
+            po = skipWhiteSpace(data, size, po + 1);
+        }
+        return JsonDocumentView();
+    }
+
+    inline JsonDocumentView JsonDocumentView::at(const size_t& index) const {
+        if (!data || data[position] != '[') {
+            return JsonDocumentView();
+        }
+        size_t po = skipWhiteSpace(data, size, position + 1);
+        for (size_t k = 0; po < size && data[po] != ']'; ++k) {
+            if (k == index) {
+                return JsonDocumentView(data, size, po);
+            }
+            po = skipWhiteSpace(data, size, skipValue(data, size, po));
+            if (po == size || data[po] != ',') {
+                break;
+            }
+            po = skipWhiteSpace(data, size, po + 1);
+        }
+        return JsonDocumentView();
+    }
+
+    inline JsonDocumentView JsonDocumentView::operator[](const std::string_view& key) const {
+        return at(key);
+    }
+
+    inline JsonDocumentView JsonDocumentView::operator[](const size_t& index) const {
+        return at(index);
+    }
+
+    inline bool JsonDocumentView::isNull() const {
+        return data && size - position >= 4 && std::memcmp(data + position, "null", 4) == 0;
+    }
+
+    //tells a false value from anything asBoolean reads as false
+    inline bool JsonDocumentView::isBoolean() const {
+        return asBoolean() || (data && size - position >= 5 && std::memcmp(data + position, "false", 5) == 0);
+    }
+
+    //false for anything but true, see isBoolean
+    inline bool JsonDocumentView::asBoolean() const {
+        return data && size - position >= 4 && std::memcmp(data + position, "true", 4) == 0;
+    }
+
+    //0 when the value is not an integer that fits in a long
+    inline long JsonDocumentView::asInteger() const {
+        long result = 0;
+        if (data) {
+            auto end = data + skipValue(data, size, position);
+            if (std::from_chars(data + position, end, result).ptr != end) {
+                result = 0;
+            }
+        }
+        return result;
+    }
+
+    //integers are converted too, anything else gives 0
+    inline double JsonDocumentView::asDecimal() const {
+        double result = 0;
+        if (data) {
+            auto end = data + skipValue(data, size, position);
+            if (std::from_chars(data + position, end, result).ptr != end) {
+                result = 0;
+            }
+        }
+        return result;
+    }
+
+    //the decoded string, empty when the value is not a well formed string
+    inline std::string JsonDocumentView::asString() const {
+        auto view = rawString();
+        std::string result(view.size(), '\0');
+        size_t po = 0;
+        size_t written = 0;
+        if (!unescapeString(view.data(), po, view.size(), result.data(), written)) {
+            written = 0;
+        }
+        result.resize(written);
+        return result;
+    }
+
+    //the characters between the quotes with escapes left as they are
+    inline std::string_view JsonDocumentView::rawString() const {
+        if (!data || data[position] != '"') {
+            return std::string_view();
+        }
+        size_t end = skipString(data, size, position);
+        if (end > size) {
+            return std::string_view();
+        }
+        return std::string_view(data + position + 1, end - position - 2);
+    }
+
+    inline std::string_view JsonDocumentView::raw() const {
+        if (!data) {
+            return std::string_view();
+        }
+        return std::string_view(data + position, skipValue(data, size, position) - position);
+    }
+
+    //builds the DOM of this value only, with full validation
+    template <typename Alloc>
+    bool JsonDocumentView::materialize(Json<Alloc>& json_ref) const {
+        auto text = raw();
+        return data && objectify(json_ref, text.data(), text.size());
+    }
+}
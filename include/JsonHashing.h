@@ -0,0 +1,101 @@
+#pragma once
+#include "Utility.h"
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace Jsoncpp {
+    //wyhash constants, the first two also mix the seed and the integers
+    constexpr uint64_t hash_secret[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //folds the 128 bit product
+    inline uint64_t hashMix(const uint64_t& a, const uint64_t& b) {
+        __uint128_t product = static_cast<__uint128_t>(a) * b;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+    }
+
+    inline uint64_t hashRead8(const_char_ptr ptr) {
+        uint64_t result;
+        std::memcpy(&result, ptr, 8);
+        return result;
+    }
+
+    inline uint64_t hashRead4(const_char_ptr ptr) {
+        uint32_t result;
+        std::memcpy(&result, ptr, 4);
+        return result;
+    }
+
+    //drawn once per process, so colliding keys cannot be computed ahead of time. random_device is mixed with the clock
+    //and the address of the seed in case it is deterministic on the platform
+    inline uint64_t hashSeed() {
+        static const uint64_t seed = [] {
+            uint64_t result = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            result ^= reinterpret_cast<uintptr_t>(&result);
+            try {
+                std::random_device device;
+                result ^= (static_cast<uint64_t>(device()) << 32) | device();
+            }
+            catch (...) {}
+            return hashMix(result ^ hash_secret[0], hash_secret[1]);
+        }();
+        return seed;
+    }
+
+    //wyhash: every byte goes through a 64x64->128 multiply, keys of up to 16 bytes take two reads and two multiplies
+    inline uint64_t hashBytes(const_char_ptr ptr, const size_t& length, uint64_t seed) {
+        seed ^= hashMix(seed ^ hash_secret[0], hash_secret[1]);
+        uint64_t a;
+        uint64_t b;
+        if (length <= 16) {
+            if (length >= 4) {
+                size_t shift = (length >> 3) << 2;
+                a = (hashRead4(ptr) << 32) | hashRead4(ptr + shift);
+                b = (hashRead4(ptr + length - 4) << 32) | hashRead4(ptr + length - 4 - shift);
+            }
+            else if (length) {
+                auto bytes = reinterpret_cast<const uint8_t *>(ptr);
+                a = (static_cast<uint64_t>(bytes[0]) << 16) | (static_cast<uint64_t>(bytes[length >> 1]) << 8) | bytes[length - 1];
+                b = 0;
+            }
+            else {
+                a = b = 0;
+            }
+        }
+        else {
+            size_t left = length;
+            if (left > 48) {
+                uint64_t see1 = seed;
+                uint64_t see2 = seed;
+                do {
+                    seed = hashMix(hashRead8(ptr) ^ hash_secret[1], hashRead8(ptr + 8) ^ seed);
+                    see1 = hashMix(hashRead8(ptr + 16) ^ hash_secret[2], hashRead8(ptr + 24) ^ see1);
+                    see2 = hashMix(hashRead8(ptr + 32) ^ hash_secret[3], hashRead8(ptr + 40) ^ see2);
+                    ptr += 48;
+                    left -= 48;
+                } while (left > 48);
+                seed ^= see1 ^ see2;
+            }
+            while (left > 16) {
+                seed = hashMix(hashRead8(ptr) ^ hash_secret[1], hashRead8(ptr + 8) ^ seed);
+                ptr += 16;
+                left -= 16;
+            }
+            a = hashRead8(ptr + left - 16);
+            b = hashRead8(ptr + left - 8);
+        }
+        a ^= hash_secret[1];
+        b ^= seed;
+        __uint128_t product = static_cast<__uint128_t>(a) * b;
+        a = static_cast<uint64_t>(product);
+        b = static_cast<uint64_t>(product >> 64);
+        return hashMix(a ^ hash_secret[0] ^ length, b ^ hash_secret[1]);
+    }
+
+    //integers are mixed too, their low bits alone would put consecutive values in consecutive groups
+    inline uint64_t hashInteger(const uint64_t& value, const uint64_t& seed) {
+        return hashMix(value ^ seed ^ hash_secret[0], hash_secret[1]);
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include "JsonClass.h"
+#include "JsonArena.h"
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+namespace Jsoncpp {
+    //JsonKeyDictionary class
+    //keys shared between documents and threads: every distinct key is stored once, with its hash and a dense id.
+    //Strings made from an entry carry no copy of the characters, so the dictionary must outlive every document that
+    //uses it. Entries are never removed
+    struct JsonKeyDictionary {
+        static constexpr size_t initial_table_size = 64;
+
+        JsonArena arena;
+        //open addressing over the cached hashes, at most half full
+        std::vector<const JsonInternedKey *> table;
+        std::vector<const JsonInternedKey *> keys;
+        mutable std::shared_mutex mutex;
+
+        JsonKeyDictionary();
+        JsonKeyDictionary(const JsonKeyDictionary &other) = delete;
+        JsonKeyDictionary &operator=(const JsonKeyDictionary &other) = delete;
+        const JsonInternedKey &intern(const std::string_view& key);
+        const JsonInternedKey *find(const std::string_view& key) const;
+        const JsonInternedKey &operator[](const size_t& id) const;
+        size_t size() const;
+        template <typename Alloc = std::allocator<char>>
+        JsonString<Alloc> key(const std::string_view& key);
+
+        size_t probe(const std::string_view& key, const size_t& hash_value) const;
+        void grow();
+    };
+
+    //JsonKeyCache class
+    //a small direct mapped cache in front of a dictionary, owned by one thread. A hit is found from the length and the
+    //first characters and costs one compare, with no hashing and no lock
+    struct JsonKeyCache {
+        static constexpr size_t bits = 6;
+        static constexpr size_t size = size_t(1) << bits;
+
+        JsonKeyDictionary *dictionary;
+        const JsonInternedKey *entries[size] = {};
+
+        JsonKeyCache(JsonKeyDictionary *d = nullptr);
+        const JsonInternedKey &intern(const std::string_view& key);
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //JsonKeyDictionary class member function
+
+    inline JsonKeyDictionary::JsonKeyDictionary() : table(initial_table_size, nullptr) {}
+
+    //returns the slot holding key or the empty slot where it belongs, expects the caller to hold the lock
+    inline size_t JsonKeyDictionary::probe(const std::string_view& key, const size_t& hash_value) const {
+        size_t mask = table.size() - 1;
+        for (size_t slot = hash_value & mask;; slot = (slot + 1) & mask) {
+            auto entry = table[slot];
+            if (!entry || (entry->hash == hash_value && entry->length == key.size() && (!key.size() || std::memcmp(entry->data(), key.data(), key.size()) == 0))) {
+                return slot;
+            }
+        }
+    }
+
+    inline void JsonKeyDictionary::grow() {
+        std::vector<const JsonInternedKey *> temp(table.size() * 2, nullptr);
+        size_t mask = temp.size() - 1;
+        for (auto &entry : keys) {
+            size_t slot = entry->hash & mask;
+            while (temp[slot]) {
+                slot = (slot + 1) & mask;
+            }
+            temp[slot] = entry;
+        }
+        table.swap(temp);
+    }
+
+    //a key seen before only takes the shared lock, a new one is added under the exclusive lock
+    inline const JsonInternedKey& JsonKeyDictionary::intern(const std::string_view& key) {
+        size_t hash_value = JsonObject<>::hasher(key);
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto entry = table[probe(key, hash_value)];
+            if (entry) {
+                return *entry;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto slot = probe(key, hash_value);
+        if (table[slot]) {
+            return *table[slot];
+        }
+        if ((keys.size() + 1) * 2 > table.size()) {
+            grow();
+            slot = probe(key, hash_value);
+        }
+        auto entry = new (arena.allocate(sizeof(JsonInternedKey) + key.size(), alignof(JsonInternedKey))) JsonInternedKey{hash_value, static_cast<uint32_t>(keys.size()), static_cast<uint32_t>(key.size())};
+        if (!key.empty()) {
+            std::memcpy(const_cast<char_ptr>(entry->data()), key.data(), key.size());
+        }
+        table[slot] = entry;
+        keys.push_back(entry);
+        return *entry;
+    }
+
+    inline const JsonInternedKey* JsonKeyDictionary::find(const std::string_view& key) const {
+        size_t hash_value = JsonObject<>::hasher(key);
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return table[probe(key, hash_value)];
+    }
+
+    inline const JsonInternedKey& JsonKeyDictionary::operator[](const size_t& id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return *keys[id];
+    }
+
+    inline size_t JsonKeyDictionary::size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return keys.size();
+    }
+
+    //a string pointing at the interned copy of key, ready for JsonObject lookups and inserts
+    template <typename Alloc>
+    inline JsonString<Alloc> JsonKeyDictionary::key(const std::string_view& key) {
+        return JsonString<Alloc>(intern(key));
+    }
+
+    //JsonKeyCache class member function
+
+    inline JsonKeyCache::JsonKeyCache(JsonKeyDictionary *d) : dictionary(d) {}
+
+    inline const JsonInternedKey& JsonKeyCache::intern(const std::string_view& key) {
+        uint64_t prefix = 0;
+        if (key.size()) {
+            std::memcpy(&prefix, key.data(), key.size() < 7 ? key.size() : 7);
+        }
+        size_t slot = ((prefix ^ key.size() << 56) * 0x9E3779B97F4A7C15ull) >> (64 - bits);
+        auto &entry = entries[slot];
+        if (!entry || entry->length != key.size() || (key.size() && std::memcmp(entry->data(), key.data(), key.size()) != 0)) {
+            entry = &dictionary->intern(key);
+        }
+        return *entry;
+    }
+}
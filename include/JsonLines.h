@@ -0,0 +1,239 @@
+#pragma once
+#include "JsonArena.h"
+#include "JsonParser.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Jsoncpp {
+    struct JsonLinesOptions {
+        //0 starts one worker per hardware thread
+        size_t threads = 0;
+        //bytes of input per batch, every batch is extended to the end of its last line
+        size_t batch_size = 1024 * 1024;
+        ParseOptions parse;
+    };
+
+    //JsonLinesBatch class
+    //a run of whole lines parsed by one worker. Records are placed in the batch's own arena, which is reset without
+    //running destructors when the batch slot is reused
+    struct JsonLinesBatch {
+        using allocator_type = JsonArenaAllocator<char>;
+        using value_type = Json<allocator_type>;
+
+        struct Record {
+            value_type *value;
+            size_t line;
+            size_t offset;
+        };
+
+        JsonArena arena;
+        std::vector<Record> records;
+        size_t line_count = 0;
+        size_t error_position = JsonStructuralIndex::no_error;
+        //the batch this slot holds or waits for, ready once a worker has parsed it
+        size_t ticket = 0;
+        bool ready = false;
+
+        allocator_type allocator();
+        void clear();
+    };
+
+    //JsonLinesReader class
+    //parses newline delimited JSON on a pool of worker threads and hands the records to callback in input order as
+    //callback(line, value). A value lives in its batch's arena and is only valid until the callback returns. Workers
+    //run ahead of the callback by at most two batches each, blank lines are skipped but still counted
+    template <typename Callback>
+    struct JsonLinesReader {
+        using allocator_type = JsonLinesBatch::allocator_type;
+        using value_type = JsonLinesBatch::value_type;
+
+        const_char_ptr data;
+        size_t size;
+        Callback &callback;
+        JsonLinesOptions options;
+        std::vector<size_t> bounds;
+        std::unique_ptr<JsonLinesBatch[]> batches;
+        size_t slot_count = 0;
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool stopped = false;
+        size_t error_position = 0;
+
+        JsonLinesReader(const_char_ptr ptr, const size_t& s, Callback &c, const JsonLinesOptions& o = JsonLinesOptions());
+        bool run();
+        void split();
+        void work();
+        void parseBatch(JsonSaxParser<JsonDomBuilder<allocator_type>>& reader, JsonDomBuilder<allocator_type>& builder, JsonLinesBatch& batch, const size_t& k);
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //JsonLinesBatch class member function
+
+    inline JsonLinesBatch::allocator_type JsonLinesBatch::allocator() {
+        return allocator_type(&arena);
+    }
+
+    inline void JsonLinesBatch::clear() {
+        arena.reset();
+        records.clear();
+        line_count = 0;
+        error_position = JsonStructuralIndex::no_error;
+    }
+
+    //JsonLinesReader class member function
+
+    template <typename Callback>
+    inline JsonLinesReader<Callback>::JsonLinesReader(const_char_ptr ptr, const size_t& s, Callback &c, const JsonLinesOptions& o)
+    : data(ptr), size(s), callback(c), options(o) {}
+
+    //batch k is the input between bounds[k] and bounds[k + 1], only the newline after every boundary is searched for
+    template <typename Callback>
+    void JsonLinesReader<Callback>::split() {
+        size_t batch_size = options.batch_size ? options.batch_size : 1;
+        bounds.assign(1, 0);
+        while (bounds.back() < size) {
+            size_t po = bounds.back() + batch_size;
+            if (po >= size) {
+                bounds.push_back(size);
+                break;
+            }
+            auto newline = static_cast<const_char_ptr>(std::memchr(data + po - 1, '\n', size - po + 1));
+            bounds.push_back(newline ? newline - data + 1 : size);
+        }
+    }
+
+    template <typename Callback>
+    void JsonLinesReader<Callback>::parseBatch(JsonSaxParser<JsonDomBuilder<allocator_type>>& reader, JsonDomBuilder<allocator_type>& builder, JsonLinesBatch& batch, const size_t& k) {
+        batch.clear();
+        builder.allocator = batch.allocator();
+        size_t end = bounds[k + 1];
+        size_t line = 0;
+        for (size_t po = bounds[k]; po < end; ++line) {
+            auto newline = static_cast<const_char_ptr>(std::memchr(data + po, '\n', end - po));
+            size_t line_end = newline ? newline - data : end;
+            size_t first = po;
+            while (first < line_end && isWhiteSpace(data[first])) {
+                ++first;
+            }
+            if (first < line_end) {
+                auto value = new (batch.arena.allocate(sizeof(value_type), alignof(value_type))) value_type(JsonType::Null, batch.allocator());
+                builder.clear();
+                reader.reset(data + po, line_end - po);
+                if (!reader.parse() || !builder.take(*value)) {
+                    batch.error_position = po + reader.position;
+                    builder.clear();
+                    return;
+                }
+                batch.records.push_back({value, line, po});
+            }
+            po = line_end + 1;
+        }
+        batch.line_count = line;
+    }
+
+    template <typename Callback>
+    void JsonLinesReader<Callback>::work() {
+        JsonDomBuilder<allocator_type> builder(allocator_type(), options.parse);
+        JsonSaxParser<JsonDomBuilder<allocator_type>> reader(data, 0, builder);
+        for (;;) {
+            size_t k = next.fetch_add(1);
+            if (k + 1 >= bounds.size()) {
+                return;
+            }
+            auto &batch = batches[k % slot_count];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return stopped || (batch.ticket == k && !batch.ready); });
+                if (stopped) {
+                    return;
+                }
+            }
+            parseBatch(reader, builder, batch, k);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                batch.ready = true;
+            }
+            changed.notify_all();
+        }
+    }
+
+    //the calling thread only delivers, a malformed line or a callback returning false stops every worker
+    template <typename Callback>
+    bool JsonLinesReader<Callback>::run() {
+        split();
+        size_t count = bounds.size() - 1;
+        if (!count) {
+            return true;
+        }
+        size_t threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+        if (!threads) {
+            threads = 1;
+        }
+        if (threads > count) {
+            threads = count;
+        }
+        slot_count = 2 * threads;
+        batches.reset(new JsonLinesBatch[slot_count]);
+        for (size_t k = 0; k < slot_count; ++k) {
+            batches[k].ticket = k;
+        }
+        std::vector<std::thread> workers;
+        for (size_t k = 0; k < threads; ++k) {
+            workers.emplace_back([this] { work(); });
+        }
+        bool result = true;
+        size_t line = 0;
+        for (size_t k = 0; k < count && result; ++k) {
+            auto &batch = batches[k % slot_count];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return batch.ticket == k && batch.ready; });
+            }
+            for (auto &record : batch.records) {
+                if (!callback(line + record.line, *record.value)) {
+                    error_position = record.offset;
+                    result = false;
+                    break;
+                }
+            }
+            if (result && batch.error_position != JsonStructuralIndex::no_error) {
+                error_position = batch.error_position;
+                result = false;
+            }
+            line += batch.line_count;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                batch.ready = false;
+                batch.ticket += slot_count;
+                stopped = !result;
+            }
+            changed.notify_all();
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        return result;
+    }
+
+    //error_position is the offset of the malformed line's error, or of the record the callback stopped on
+    template <typename Ptr, typename Callback, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
+    bool parseLines(const Ptr& ptr, const size_t& size, Callback callback, const JsonLinesOptions& options, size_t& error_position) {
+        JsonLinesReader<Callback> reader(ptr, size, callback, options);
+        if (reader.run()) {
+            return true;
+        }
+        error_position = reader.error_position;
+        return false;
+    }
+
+    template <typename Ptr, typename Callback, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
+    bool parseLines(const Ptr& ptr, const size_t& size, Callback callback, const JsonLinesOptions& options = JsonLinesOptions()) {
+        size_t error_position;
+        return parseLines(ptr, size, callback, options, error_position);
+    }
+}
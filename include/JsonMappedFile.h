@@ -0,0 +1,164 @@
+#pragma once
+#include "JsonParser.h"
+#include <limits>
+
+#ifdef JSONCPP_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Jsoncpp {
+    //error_position of the file entry points when the file cannot be opened or read
+    constexpr size_t file_error = std::numeric_limits<size_t>::max();
+
+    //JsonMappedFile class
+    //a whole file mapped read only, the kernel is told it will be read front to back so it reads ahead and drops
+    //pages behind the parser. Without mmap the file is read into a buffer instead
+    struct JsonMappedFile {
+        const_char_ptr data = nullptr;
+        size_t size = 0;
+#ifndef JSONCPP_POSIX
+        std::unique_ptr<char[]> buffer;
+#endif
+
+        JsonMappedFile() = default;
+        JsonMappedFile(const JsonMappedFile &other) = delete;
+        JsonMappedFile(JsonMappedFile &&other) noexcept;
+        JsonMappedFile &operator=(const JsonMappedFile &other) = delete;
+        JsonMappedFile &operator=(JsonMappedFile &&other) noexcept;
+        ~JsonMappedFile();
+        bool open(const char *path);
+        void close();
+        bool isOpen() const;
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //JsonMappedFile class member function
+
+    inline JsonMappedFile::JsonMappedFile(JsonMappedFile &&other) noexcept
+    : data(other.data), size(other.size) {
+#ifndef JSONCPP_POSIX
+        buffer = std::move(other.buffer);
+#endif
+        other.data = nullptr;
+        other.size = 0;
+    }
+
+    inline JsonMappedFile& JsonMappedFile::operator=(JsonMappedFile &&other) noexcept {
+        if (this != &other) {
+            close();
+            data = other.data;
+            size = other.size;
+#ifndef JSONCPP_POSIX
+            buffer = std::move(other.buffer);
+#endif
+            other.data = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    inline JsonMappedFile::~JsonMappedFile() {
+        close();
+    }
+
+    //an empty file opens with data pointing at an empty string
+#ifdef JSONCPP_POSIX
+    inline bool JsonMappedFile::open(const char *path) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat status;
+        if (::fstat(fd, &status) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(status.st_size);
+        if (!size) {
+            ::close(fd);
+            data = "";
+            return true;
+        }
+        auto mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            size = 0;
+            return false;
+        }
+        ::madvise(mapping, size, MADV_SEQUENTIAL);
+        ::madvise(mapping, size, MADV_WILLNEED);
+        data = static_cast<const_char_ptr>(mapping);
+        return true;
+    }
+
+    inline void JsonMappedFile::close() {
+        if (size) {
+            ::munmap(const_cast<char_ptr>(data), size);
+        }
+        data = nullptr;
+        size = 0;
+    }
+#else
+    inline bool JsonMappedFile::open(const char *path) {
+        close();
+        auto file = std::fopen(path, "rb");
+        if (!file) {
+            return false;
+        }
+        bool result = std::fseek(file, 0, SEEK_END) == 0;
+        long length = result ? std::ftell(file) : -1;
+        if (length < 0 || std::fseek(file, 0, SEEK_SET) != 0) {
+            std::fclose(file);
+            return false;
+        }
+        buffer.reset(new char[length + 1]);
+        size = static_cast<size_t>(length);
+        result = std::fread(buffer.get(), 1, size, file) == size;
+        std::fclose(file);
+        if (!result) {
+            close();
+            return false;
+        }
+        data = buffer.get();
+        return true;
+    }
+
+    inline void JsonMappedFile::close() {
+        buffer.reset();
+        data = nullptr;
+        size = 0;
+    }
+#endif
+
+    inline bool JsonMappedFile::isOpen() const {
+        return data;
+    }
+
+    //strings are always copied out of the mapping, which is gone once this returns. error_position is file_error
+    //when the file cannot be read
+    template <typename Alloc>
+    bool objectifyFile(Json<Alloc>& json_ref, const char *path, ParseOptions options, size_t& error_position) {
+        JsonMappedFile file;
+        if (!file.open(path)) {
+            error_position = file_error;
+            return false;
+        }
+        options.borrow_strings = false;
+        return objectify(json_ref, file.data, file.size, options, error_position);
+    }
+
+    template <typename Alloc>
+    bool objectifyFile(Json<Alloc>& json_ref, const char *path, size_t& error_position) {
+        return objectifyFile(json_ref, path, ParseOptions(), error_position);
+    }
+
+    template <typename Alloc>
+    bool objectifyFile(Json<Alloc>& json_ref, const char *path) {
+        size_t error_position;
+        return objectifyFile(json_ref, path, error_position);
+    }
+}
@@ -1,256 +1,943 @@
 #pragma once
 #include "JsonClass.h"
+#include "JsonKeyDictionary.h"
+#include "JsonStructuralIndex.h"
+#include "JsonSerializer.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <limits>
+
 namespace Jsoncpp {
-    template <typename Alloc, typename Ptr, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
-    bool objectify(Json<Alloc>& json_ref, const Ptr& ptr, const size_t& size) {
-        struct Position {
-            std::string_view view;
-            Json<Alloc> *json_ptr;
-            Position() = default;
-            Position(const std::string_view& v, Json<Alloc>* const& p) : view(v), json_ptr(p) {}
+    //nodes are destroyed, hashed, compared and written recursively, so nesting is capped to keep untrusted input from
+    //running the stack out
+    constexpr size_t default_max_depth = 1024;
+
+    struct ParseOptions {
+        //string values and keys without escapes point into the input instead of copying it, the input must outlive the result
+        bool borrow_strings = false;
+        //objectify parses a large top level array on this many threads, the allocator must then be stateless
+        size_t threads = 1;
+        //object keys are interned here instead of being copied, the dictionary must outlive the result
+        JsonKeyDictionary *keys = nullptr;
+        //an array or object opened deeper than this fails the parse at its bracket
+        size_t max_depth = default_max_depth;
+    };
+
+    //JsonSaxHandler class
+    //every event a JsonSaxParser sends, each one returns false to stop the parse. Handlers derive from this and hide
+    //the events they care about, calls are resolved at compile time so nothing is virtual. Strings and keys come
+    //decoded, in_input tells that the characters point into the parsed input rather than a scratch buffer that the
+    //next event overwrites
+    struct JsonSaxHandler {
+        bool startObject();
+        bool endObject();
+        bool startArray();
+        bool endArray();
+        bool key(const_char_ptr ptr, const size_t& length, const bool& in_input);
+        bool string(const_char_ptr ptr, const size_t& length, const bool& in_input);
+        bool integer(const long& value);
+        bool decimal(const double& value);
+        bool boolean(const bool& value);
+        bool null();
+    };
+
+    //JsonSaxParser class
+    //the tokenizer every parser is built on: it validates the input and turns it into handler events. The structural
+    //index is built one window at a time, so apart from what the handler keeps memory grows only with the nesting depth
+    template <typename Handler>
+    struct JsonSaxParser {
+        static constexpr size_t default_window = 64 * 1024;
+
+        const_char_ptr data;
+        size_t size;
+        size_t window;
+        size_t position = 0;
+        size_t structural = 0;
+        JsonStructuralIndex index;
+        std::vector<JsonType> frames;
+        std::string scratch;
+        Handler &handler;
+        //the input is a comma separated run of array elements, reported as one array
+        bool elements = false;
+
+        JsonSaxParser(const_char_ptr ptr, const size_t& s, Handler &h, const size_t& w = default_window);
+        void reset(const_char_ptr ptr, const size_t& s);
+        bool parse();
+        bool parseElements();
+        bool parseIndexed();
+        bool parseStructure();
+        bool nextWindow();
+        bool nextStructural();
+        size_t peekPosition();
+        bool peekStructural(const char& ch);
+        bool scalarEnded();
+        bool parseString(const bool& is_key);
+        bool parseNumber();
+        bool parseLiteral(const_char_ptr literal, const size_t& length);
+    };
+
+    //JsonDomBuilder class
+    //the JsonSaxHandler that builds a Json tree, finished values wait on a stack until their container closes
+    template <typename Alloc = std::allocator<char>>
+    struct JsonDomBuilder {
+        std::vector<Json<Alloc>> values;
+        std::vector<size_t> frames;
+        Alloc allocator;
+        ParseOptions options;
+        JsonKeyCache key_cache;
+
+        JsonDomBuilder(const Alloc& a = Alloc(), const ParseOptions& o = ParseOptions());
+        bool startObject();
+        bool endObject();
+        bool startArray();
+        bool endArray();
+        bool key(const_char_ptr ptr, const size_t& length, const bool& in_input);
+        bool string(const_char_ptr ptr, const size_t& length, const bool& in_input);
+        bool integer(const long& value);
+        bool decimal(const double& value);
+        bool boolean(const bool& value);
+        bool null();
+        bool take(Json<Alloc>& json_ref);
+        void clear();
+    };
+
+    //JsonParser class
+    template <typename Alloc = std::allocator<char>>
+    struct JsonParser {
+        JsonDomBuilder<Alloc> builder;
+        JsonSaxParser<JsonDomBuilder<Alloc>> reader;
+        size_t position = 0;
+
+        JsonParser(const_char_ptr ptr, const size_t& s, const Alloc& a = Alloc(), const ParseOptions& o = ParseOptions());
+        JsonParser(const JsonParser &other) = delete;
+        JsonParser &operator=(const JsonParser &other) = delete;
+        bool parse(Json<Alloc>& json_ref);
+    };
+
+    //JsonParallelParser class
+    //parses a document whose root is an array on several threads. One pass over the structural index finds top level
+    //commas near evenly spaced offsets, each thread parses its run of elements and the element nodes are then moved
+    //into the root array, their subtrees stay where the threads built them. Anything else is parsed on one thread
+    template <typename Alloc = std::allocator<char>>
+    struct JsonParallelParser {
+        static constexpr size_t min_range = 64 * 1024;
+
+        struct Range {
+            size_t begin;
+            size_t end;
+            Json<Alloc> elements;
+            size_t error_position;
+            bool parsed;
         };
-        Json<Alloc> result;
-        std::deque<Position> que;
-        que.emplace_back(std::string_view(ptr, size), &result);
-        bool correct = true;
-        while (correct && !que.empty())
-        {
-            auto& top = que.front();
-            auto &view = top.view;
-            view = trimWhiteSpace(view.data(), view.size());
-            auto s = view.size();
-            auto &front = view.front();
-            auto &back = view.back();
-            auto &cur_json = *(top.json_ptr);
-            if (front == '{' && back == '}')
-            {
-                cur_json = JsonObject<Alloc>();
-                auto funct = [&que, &cur_json, &correct](const std::string_view &v)
-                {
-                    auto trimmed = trimWhiteSpace(v.data(), v.size());
-                    if (trimmed.front() != '"')
-                    {
-                        correct = false;
-                        return;
-                    }
-                    auto len = trimmed.size();
-                    auto char_data = trimmed.data();
-                    auto close_quote_position = findClosingBrace(char_data, len, 0);
-                    if (close_quote_position == len)
-                    {
-                        correct = false;
-                        return;
+
+        const_char_ptr data;
+        size_t size;
+        Alloc allocator;
+        ParseOptions options;
+        size_t position = 0;
+        std::vector<Range> ranges;
+
+        JsonParallelParser(const_char_ptr ptr, const size_t& s, const Alloc& a = Alloc(), const ParseOptions& o = ParseOptions());
+        bool parse(Json<Alloc>& json_ref);
+        bool split(const size_t& threads);
+        void parseRange(Range& range);
+    };
+
+    constexpr bool isWhiteSpace(const char& ch) {
+        return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+    }
+
+    constexpr bool isDigit(const char& ch) {
+        return ch >= '0' && ch <= '9';
+    }
+
+    constexpr int hexValue(const char& ch) {
+        if (ch >= '0' && ch <= '9') {
+            return ch - '0';
+        }
+        if (ch >= 'a' && ch <= 'f') {
+            return ch - 'a' + 10;
+        }
+        if (ch >= 'A' && ch <= 'F') {
+            return ch - 'A' + 10;
+        }
+        return -1;
+    }
+
+    //appends code_point to des as utf-8, returns the number of bytes written
+    inline size_t encodeUtf8(char_ptr des, const unsigned long& code_point) {
+        if (code_point < 0x80) {
+            des[0] = static_cast<char>(code_point);
+            return 1;
+        }
+        if (code_point < 0x800) {
+            des[0] = static_cast<char>(0xC0 | (code_point >> 6));
+            des[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 2;
+        }
+        if (code_point < 0x10000) {
+            des[0] = static_cast<char>(0xE0 | (code_point >> 12));
+            des[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            des[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 3;
+        }
+        des[0] = static_cast<char>(0xF0 | (code_point >> 18));
+        des[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        des[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        des[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+        return 4;
+    }
+
+    //decodes the escape sequence starting after the backslash at src[0], returns the number of source bytes consumed or 0 on error
+    inline size_t decodeEscape(const_char_ptr src, const size_t& size, char_ptr des, size_t& written) {
+        if (size == 0) {
+            return 0;
+        }
+        written = 1;
+        switch (src[0]) {
+            case '"': des[0] = '"'; return 1;
+            case '\\': des[0] = '\\'; return 1;
+            case '/': des[0] = '/'; return 1;
+            case 'b': des[0] = '\b'; return 1;
+            case 'f': des[0] = '\f'; return 1;
+            case 'n': des[0] = '\n'; return 1;
+            case 'r': des[0] = '\r'; return 1;
+            case 't': des[0] = '\t'; return 1;
+            case 'u': {
+                auto read_hex = [&src, &size](const size_t& po, unsigned long& value) {
+                    if (po + 4 > size) {
+                        return false;
                     }
-                    for (size_t k = close_quote_position + 1; k < len; ++k)
-                    {
-                        if (trimmed[k] == ':')
-                        {
-                            auto key = JsonString<Alloc>(char_data + 1, close_quote_position - 1);
-                            reinterpret_cast<JsonObject<Alloc>*>(&cur_json)->insert(key, Json());
-                            que.emplace_back(std::string_view(char_data + k + 1, len - k - 1), &((*reinterpret_cast<JsonObject<Alloc>*>(&cur_json))[key]));
-                            return;
-                        }
-                        if (trimmed[k] != ' ')
-                        {
-                            correct = false;
-                            return;
+                    value = 0;
+                    for (size_t k = po; k < po + 4; ++k) {
+                        auto digit = hexValue(src[k]);
+                        if (digit < 0) {
+                            return false;
                         }
+                        value = (value << 4) | digit;
                     }
-                    correct = false;
-                };
-                splitToView<','>(view.data() + 1, s - 2, funct);
-            }
-            else if (front == '[' && back == ']') {
-                cur_json = JsonArray<Alloc>();
-                auto funct = [&que, &cur_json, &correct](const std::string_view &v)
-                {
-                    auto *cur_json_ptr = reinterpret_cast<JsonArray<Alloc> *>(&cur_json);
-                    cur_json_ptr->pushBack(Json<Alloc>());
-                    que.emplace_back(v, &((*cur_json_ptr)[cur_json_ptr->length() - 1]));
+                    return true;
                 };
+                unsigned long code_point;
+                if (!read_hex(1, code_point)) {
+                    return 0;
+                }
+                if (code_point >= 0xD800 && code_point < 0xDC00) {
+                    unsigned long low;
+                    if (size < 11 || src[5] != '\\' || src[6] != 'u' || !read_hex(7, low) || low < 0xDC00 || low >= 0xE000) {
+                        return 0;
+                    }
+                    written = encodeUtf8(des, 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00));
+                    return 11;
+                }
+                if (code_point >= 0xDC00 && code_point < 0xE000) {
+                    return 0;
+                }
+                written = encodeUtf8(des, code_point);
+                return 5;
             }
-            else if (front == '\"' && back == '\"') {
-                cur_json = JsonString<Alloc>(view.data() + 1, s - 2);
+            default: {
+                return 0;
             }
-            else if (s == 4 && compare(view.data(), "null", 4)) {
-                cur_json = JsonNull<Alloc>();
+        }
+    }
+
+    //decodes data[position, end) into des, which must hold end - position bytes. On a bad escape it returns false with
+    //position at the backslash, otherwise position ends at end
+    inline bool unescapeString(const_char_ptr data, size_t& position, const size_t& end, char_ptr des, size_t& written) {
+        written = 0;
+        while (position < end) {
+            auto escape = static_cast<const_char_ptr>(std::memchr(data + position, '\\', end - position));
+            size_t run = (escape ? escape - data : end) - position;
+            std::memcpy(des + written, data + position, run);
+            written += run;
+            position += run;
+            if (!escape) {
+                break;
             }
-            else {
-                long temp_l;
-                auto err = std::from_chars(view.begin(), view.end(), temp_l);
-                if (err.ptr == view.end())
-                {
-                    cur_json = JsonInteger<Alloc>(temp_l);
-                    goto label0;
-                }
-                double temp_d;
-                err = std::from_chars(view.begin(), view.end(), temp_d);
-                if (err.ptr == view.end()) {
-                    cur_json = JsonDecimal<Alloc>(temp_d);
-                    goto label0;
-                }
-                goto label1;
+            size_t num;
+            auto consumed = decodeEscape(data + position + 1, end - position - 1, des + written, num);
+            if (!consumed) {
+                return false;
             }
-label0:
-            que.pop_front();
-            continue;
-label1:
+            written += num;
+            position += consumed + 1;
+        }
+        return true;
+    }
+
+    //advances position over a number in JSON grammar, is_decimal is set when it has a fraction or an exponent
+    inline bool scanNumber(const_char_ptr data, const size_t& size, size_t& position, bool& is_decimal) {
+        is_decimal = false;
+        if (data[position] == '-') {
+            ++position;
+        }
+        if (position < size && data[position] == '0') {
+            ++position;
+        }
+        else if (position < size && isDigit(data[position])) {
+            while (position < size && isDigit(data[position])) {
+                ++position;
+            }
+        }
+        else {
             return false;
         }
-        if (!correct) {
+        if (position < size && data[position] == '.') {
+            is_decimal = true;
+            if (++position == size || !isDigit(data[position])) {
+                return false;
+            }
+            while (position < size && isDigit(data[position])) {
+                ++position;
+            }
+        }
+        if (position < size && (data[position] == 'e' || data[position] == 'E')) {
+            is_decimal = true;
+            ++position;
+            if (position < size && (data[position] == '+' || data[position] == '-')) {
+                ++position;
+            }
+            if (position == size || !isDigit(data[position])) {
+                return false;
+            }
+            while (position < size && isDigit(data[position])) {
+                ++position;
+            }
+        }
+        return true;
+    }
+
+    //converts a number scanNumber accepted. from_chars leaves result untouched when the value is out of range, so that
+    //case is settled here the way strtod does: infinity when the magnitude is too large, zero when it is too small
+    inline bool parseDecimal(const_char_ptr begin, const_char_ptr end, double& result) {
+        auto err = std::from_chars(begin, end, result);
+        if (err.ec == std::errc()) {
+            return true;
+        }
+        if (err.ec != std::errc::result_out_of_range) {
             return false;
         }
-        json_ref = std::move(result);
+        bool negative = *begin == '-';
+        auto ptr = begin + negative;
+        //the decimal exponent of the first significant digit decides which way the value left the range
+        long magnitude = 0;
+        bool significant = false;
+        for (; ptr != end && isDigit(*ptr); ++ptr) {
+            significant |= *ptr != '0';
+            magnitude += significant;
+        }
+        if (ptr != end && *ptr == '.') {
+            for (++ptr; ptr != end && isDigit(*ptr); ++ptr) {
+                significant |= *ptr != '0';
+                magnitude -= !significant;
+            }
+        }
+        long exponent = 0;
+        if (ptr != end && (*ptr == 'e' || *ptr == 'E')) {
+            bool exponent_negative = *++ptr == '-';
+            ptr += *ptr == '-' || *ptr == '+';
+            for (; ptr != end && exponent < 1000000; ++ptr) {
+                exponent = exponent * 10 + (*ptr - '0');
+            }
+            if (exponent_negative) {
+                exponent = -exponent;
+            }
+        }
+        result = magnitude + exponent > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+        if (negative) {
+            result = -result;
+        }
         return true;
     }
 
-    template <typename Alloc, typename Ptr>
-    size_t toString(const Json<Alloc>& json, Ptr ptr, const size_t& s) {
-        size_t result = 0;
-        switch (json.type)
-        {
-            case JsonType::String: {
-                result = 2 + json.json.dynamic_container.length;
-                if ((result = 2 + json.json.dynamic_container.length)> s) {
-                    return 0;
+    //JsonSaxHandler class member function
+
+    inline bool JsonSaxHandler::startObject() {
+        return true;
+    }
+
+    inline bool JsonSaxHandler::endObject() {
+        return true;
+    }
+
+    inline bool JsonSaxHandler::startArray() {
+        return true;
+    }
+
+    inline bool JsonSaxHandler::endArray() {
+        return true;
+    }
+
+    inline bool JsonSaxHandler::key(const_char_ptr, const size_t&, const bool&) {
+        return true;
+    }
+
+    inline bool JsonSaxHandler::string(const_char_ptr, const size_t&, const bool&) {
+        return true;
+    }
+
+    inline bool JsonSaxHandler::integer(const long&) {
+        return true;
+    }
+
+    inline bool JsonSaxHandler::decimal(const double&) {
+        return true;
+    }
+
+    inline bool JsonSaxHandler::boolean(const bool&) {
+        return true;
+    }
+
+    inline bool JsonSaxHandler::null() {
+        return true;
+    }
+
+    //JsonSaxParser class member function
+
+    template <typename Handler>
+    inline JsonSaxParser<Handler>::JsonSaxParser(const_char_ptr ptr, const size_t& s, Handler &h, const size_t& w)
+    : data(ptr), size(s), window(w), handler(h) {}
+
+    //indexes windows until one holds a structural, false at the end of input
+    template <typename Handler>
+    bool JsonSaxParser<Handler>::nextWindow() {
+        while (index.buildNext(data, size, window)) {
+            structural = 0;
+            if (index.count) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename Handler>
+    inline bool JsonSaxParser<Handler>::nextStructural() {
+        if (structural == index.count && !nextWindow()) {
+            position = size;
+            return false;
+        }
+        position = index[structural++];
+        return true;
+    }
+
+    //the position of the next structural without moving to it, size if there is none
+    template <typename Handler>
+    inline size_t JsonSaxParser<Handler>::peekPosition() {
+        if (structural == index.count && !nextWindow()) {
+            return size;
+        }
+        return index[structural];
+    }
+
+    template <typename Handler>
+    inline bool JsonSaxParser<Handler>::peekStructural(const char& ch) {
+        auto po = peekPosition();
+        return po < size && data[po] == ch;
+    }
+
+    //a scalar must be followed by whitespace, the next structural or the end of input
+    template <typename Handler>
+    inline bool JsonSaxParser<Handler>::scalarEnded() {
+        return position == size || isWhiteSpace(data[position]) || position == peekPosition();
+    }
+
+    //points the parser at new input, the index buffer is kept so parsing many small inputs does not allocate
+    template <typename Handler>
+    inline void JsonSaxParser<Handler>::reset(const_char_ptr ptr, const size_t& s) {
+        data = ptr;
+        size = s;
+        position = 0;
+    }
+
+    template <typename Handler>
+    bool JsonSaxParser<Handler>::parse() {
+        index.start();
+        return parseIndexed();
+    }
+
+    template <typename Handler>
+    bool JsonSaxParser<Handler>::parseElements() {
+        index.start();
+        elements = true;
+        bool result = parseIndexed();
+        elements = false;
+        return result;
+    }
+
+    //parses from wherever the index is, a caller that wants to size something from the first window builds it first
+    template <typename Handler>
+    bool JsonSaxParser<Handler>::parseIndexed() {
+        if (parseStructure()) {
+            if (index.error_position == JsonStructuralIndex::no_error) {
+                return true;
+            }
+            position = index.error_position;
+            return false;
+        }
+        if (index.error_position < position) {
+            position = index.error_position;
+        }
+        return false;
+    }
+
+    template <typename Handler>
+    bool JsonSaxParser<Handler>::parseStructure() {
+        structural = 0;
+        frames.clear();
+        if (elements) {
+            frames.push_back(JsonType::Array);
+            if (!handler.startArray()) {
+                return false;
+            }
+        }
+    value:
+        if (!nextStructural()) {
+            return false;
+        }
+        switch (data[position]) {
+            case '{': {
+                frames.push_back(JsonType::Object);
+                if (!handler.startObject()) {
+                    return false;
                 }
-                ptr[0] = '\"';
-                strncpy(ptr + 1, json.json.dynamic_container.pointer, json.json.dynamic_container.length);
-                ptr[json.json.dynamic_container.length + 1] = '\"';
-                break;
+                if (peekStructural('}')) {
+                    nextStructural();
+                    frames.pop_back();
+                    if (!handler.endObject()) {
+                        return false;
+                    }
+                    goto next;
+                }
+                goto key;
             }
-            case JsonType::Object: {
-                if ((result = 1) > s) {
-                    return 0;
+            case '[': {
+                frames.push_back(JsonType::Array);
+                if (!handler.startArray()) {
+                    return false;
                 }
-                ptr[0] = '{';
-                auto &dc = json.json.dynamic_container;
-                auto data_ptr = reinterpret_cast<JsonKeyValuePair<Alloc> *>(dc.pointer);
-                bool not_first = false;
-                for (size_t k = 0; k < dc.length; ++k)
-                {
-                    auto &cur = data_ptr[k];
-                    if (cur.active) {
-                        if (not_first) {
-                            if ((result += 1) > s) {
-                                return 0;
-                            }
-                            ptr[result - 1] = ',';
-                        }
-                        size_t change = toString(cur.key, ptr + result, s - result);
-                        if (change) {
-                            result += (change + 1);
-                            if (result > s) {
-                                return 0;
-                            }
-                            ptr[result - 1] = ':';
-                            change = toString(cur.value, ptr + result, s - result);
-                            if (change) {
-                                result += change;
-                            }
-                            else {
-                                return 0;
-                            }
-                        }
-                        else {
-                            return 0;
-                        }
-                        not_first = true;
+                if (peekStructural(']')) {
+                    nextStructural();
+                    frames.pop_back();
+                    if (!handler.endArray()) {
+                        return false;
                     }
+                    goto next;
                 }
-                if ((result += 1) > s) {
-                    return 0;
+                goto value;
+            }
+            case '"': {
+                if (!parseString(false)) {
+                    return false;
                 }
-                ptr[result - 1] = '}';
-                break;
+                goto next;
             }
-            case JsonType::Array: {
-                if ((result = 1) > s) {
-                    return 0;
+            case 't': {
+                if (!parseLiteral("true", 4) || !handler.boolean(true)) {
+                    return false;
                 }
-                ptr[0] = '[';
-                auto &dc = json.json.dynamic_container;
-                auto data_ptr = reinterpret_cast<Json<Alloc> *>(dc.pointer);
-                if (dc.length >= 1) {
-                    size_t change = toString(data_ptr[0], ptr + result, s - result);
-                    if (change) {
-                        result += change;
-                    }
-                    else {
-                        return 0;
-                    }
+                goto next;
+            }
+            case 'f': {
+                if (!parseLiteral("false", 5) || !handler.boolean(false)) {
+                    return false;
                 }
-                for (size_t k = 1; k < dc.length; ++k) {
-                    if ((result += 1) > s) {
-                        return 0;
-                    }
-                    ptr[result - 1] = ',';
-                    size_t change = toString(data_ptr[k], ptr + result, s - result);
-                    if (change) {
-                        result += change;
-                    }
-                    else {
-                        return 0;
-                    }
+                goto next;
+            }
+            case 'n': {
+                if (!parseLiteral("null", 4) || !handler.null()) {
+                    return false;
                 }
-                if ((result += 1) > s) {
-                    return 0;
+                goto next;
+            }
+            default: {
+                if (!parseNumber()) {
+                    return false;
                 }
-                ptr[result - 1] = ']';
-                break;
+                goto next;
             }
-            case JsonType::Boolean: {
-                if (json.json.boolean) {
-                    if ((result = 4) > s) {
-                        return 0;
+        }
+    key:
+        if (!nextStructural() || data[position] != '"' || !parseString(true)) {
+            return false;
+        }
+        if (!nextStructural() || data[position] != ':') {
+            return false;
+        }
+        goto value;
+    next:
+        if (frames.empty()) {
+            return !nextStructural();
+        }
+        if (!nextStructural()) {
+            if (elements && frames.size() == 1) {
+                frames.pop_back();
+                return handler.endArray();
+            }
+            return false;
+        }
+        if (data[position] == ',') {
+            if (frames.back() == JsonType::Object) {
+                goto key;
+            }
+            goto value;
+        }
+        if (frames.back() == JsonType::Object && data[position] == '}') {
+            frames.pop_back();
+            if (!handler.endObject()) {
+                return false;
+            }
+            goto next;
+        }
+        if (frames.back() == JsonType::Array && data[position] == ']' && !(elements && frames.size() == 1)) {
+            frames.pop_back();
+            if (!handler.endArray()) {
+                return false;
+            }
+            goto next;
+        }
+        return false;
+    }
+
+    //the index holds both quotes of a string, so the closing one is the next structural
+    template <typename Handler>
+    bool JsonSaxParser<Handler>::parseString(const bool& is_key) {
+        size_t start = position + 1;
+        if (!nextStructural()) {
+            return false;
+        }
+        size_t end = position;
+        const_char_ptr ptr = data + start;
+        size_t length = end - start;
+        bool in_input = !std::memchr(ptr, '\\', length);
+        if (!in_input) {
+            scratch.resize(length);
+            position = start;
+            if (!unescapeString(data, position, end, scratch.data(), length)) {
+                return false;
+            }
+            ptr = scratch.data();
+        }
+        return is_key ? handler.key(ptr, length, in_input) : handler.string(ptr, length, in_input);
+    }
+
+    template <typename Handler>
+    bool JsonSaxParser<Handler>::parseNumber() {
+        size_t start = position;
+        bool is_decimal;
+        if (!scanNumber(data, size, position, is_decimal) || !scalarEnded()) {
+            return false;
+        }
+        if (!is_decimal) {
+            long temp_l;
+            auto err = std::from_chars(data + start, data + position, temp_l);
+            if (err.ec == std::errc()) {
+                return handler.integer(temp_l);
+            }
+        }
+        double temp_d;
+        if (!parseDecimal(data + start, data + position, temp_d)) {
+            position = start;
+            return false;
+        }
+        return handler.decimal(temp_d);
+    }
+
+    template <typename Handler>
+    inline bool JsonSaxParser<Handler>::parseLiteral(const_char_ptr literal, const size_t& length) {
+        for (size_t k = 0; k < length; ++k, ++position) {
+            if (position == size || data[position] != literal[k]) {
+                return false;
+            }
+        }
+        return scalarEnded();
+    }
+
+    //JsonDomBuilder class member function
+
+    template <typename Alloc>
+    inline JsonDomBuilder<Alloc>::JsonDomBuilder(const Alloc& a, const ParseOptions& o) : allocator(a), options(o), key_cache(o.keys) {}
+
+    template <typename Alloc>
+    inline bool JsonDomBuilder<Alloc>::startObject() {
+        if (frames.size() >= options.max_depth) {
+            return false;
+        }
+        frames.push_back(values.size());
+        return true;
+    }
+
+    //keys and values alternate on the stack, the object is built at its final size
+    template <typename Alloc>
+    bool JsonDomBuilder<Alloc>::endObject() {
+        auto base = frames.back();
+        frames.pop_back();
+        JsonObject<Alloc> object((values.size() - base) / 2, allocator);
+        for (size_t k = base; k < values.size(); k += 2) {
+            object.insert(std::move(*reinterpret_cast<JsonString<Alloc> *>(&values[k])), std::move(values[k + 1]));
+        }
+        values.resize(base);
+        values.emplace_back(std::move(object));
+        return true;
+    }
+
+    template <typename Alloc>
+    inline bool JsonDomBuilder<Alloc>::startArray() {
+        if (frames.size() >= options.max_depth) {
+            return false;
+        }
+        frames.push_back(values.size());
+        return true;
+    }
+
+    template <typename Alloc>
+    bool JsonDomBuilder<Alloc>::endArray() {
+        auto base = frames.back();
+        frames.pop_back();
+        JsonArray<Alloc> array(values.size() - base, allocator);
+        array.append(values.data() + base, values.size() - base);
+        values.resize(base);
+        values.emplace_back(std::move(array));
+        return true;
+    }
+
+    template <typename Alloc>
+    inline bool JsonDomBuilder<Alloc>::key(const_char_ptr ptr, const size_t& length, const bool& in_input) {
+        if (options.keys) {
+            values.emplace_back(JsonString<Alloc>(key_cache.intern(std::string_view(ptr, length))));
+            return true;
+        }
+        return string(ptr, length, in_input);
+    }
+
+    //short strings are copied inline anyway, borrowing them would only tie them to the input
+    template <typename Alloc>
+    inline bool JsonDomBuilder<Alloc>::string(const_char_ptr ptr, const size_t& length, const bool& in_input) {
+        if (options.borrow_strings && in_input && length > max_inline_length) {
+            values.emplace_back(JsonString<Alloc>(json_borrow, ptr, length, allocator));
+        }
+        else {
+            values.emplace_back(JsonString<Alloc>(ptr, length, allocator));
+        }
+        return true;
+    }
+
+    template <typename Alloc>
+    inline bool JsonDomBuilder<Alloc>::integer(const long& value) {
+        values.emplace_back(JsonInteger<Alloc>(value));
+        return true;
+    }
+
+    template <typename Alloc>
+    inline bool JsonDomBuilder<Alloc>::decimal(const double& value) {
+        values.emplace_back(JsonDecimal<Alloc>(value));
+        return true;
+    }
+
+    template <typename Alloc>
+    inline bool JsonDomBuilder<Alloc>::boolean(const bool& value) {
+        values.emplace_back(JsonBoolean<Alloc>(value));
+        return true;
+    }
+
+    template <typename Alloc>
+    inline bool JsonDomBuilder<Alloc>::null() {
+        values.emplace_back(JsonNull<Alloc>());
+        return true;
+    }
+
+    //moves the finished document out, false if nothing or an unfinished document was built
+    template <typename Alloc>
+    bool JsonDomBuilder<Alloc>::take(Json<Alloc>& json_ref) {
+        if (!frames.empty() || values.size() != 1) {
+            return false;
+        }
+        json_ref = std::move(values.back());
+        values.clear();
+        return true;
+    }
+
+    template <typename Alloc>
+    inline void JsonDomBuilder<Alloc>::clear() {
+        values.clear();
+        frames.clear();
+    }
+
+    //JsonParser class member function
+
+    template <typename Alloc>
+    inline JsonParser<Alloc>::JsonParser(const_char_ptr ptr, const size_t& s, const Alloc& a, const ParseOptions& o)
+    : builder(a, o), reader(ptr, s, builder) {}
+
+    template <typename Alloc>
+    bool JsonParser<Alloc>::parse(Json<Alloc>& json_ref) {
+        builder.clear();
+        bool result = reader.parse() && builder.take(json_ref);
+        position = reader.position;
+        builder.clear();
+        return result;
+    }
+
+    //JsonParallelParser class member function
+
+    template <typename Alloc>
+    inline JsonParallelParser<Alloc>::JsonParallelParser(const_char_ptr ptr, const size_t& s, const Alloc& a, const ParseOptions& o)
+    : data(ptr), size(s), allocator(a), options(o) {}
+
+    //brackets are only counted here, a run whose brackets do not pair up fails when it is parsed
+    template <typename Alloc>
+    bool JsonParallelParser<Alloc>::split(const size_t& threads) {
+        JsonStructuralIndex index;
+        size_t chunk = size / threads;
+        size_t target = chunk;
+        size_t depth = 0;
+        size_t begin = 0;
+        size_t close = 0;
+        ranges.clear();
+        index.start();
+        while (index.buildNext(data, size, JsonSaxParser<JsonSaxHandler>::default_window)) {
+            for (size_t k = 0; k < index.count; ++k) {
+                size_t po = index[k];
+                if (!begin) {
+                    if (data[po] != '[') {
+                        return false;
                     }
-                    ptr[0] = 't';
-                    ptr[1] = 'r';
-                    ptr[2] = 'u';
-                    ptr[3] = 'e';
+                    begin = po + 1;
+                    depth = 1;
+                    continue;
                 }
-                else {
-                    if ((result = 5) > s) {
-                        return 0;
+                if (!depth) {
+                    return false;
+                }
+                switch (data[po]) {
+                    case '[':
+                    case '{': {
+                        ++depth;
+                        break;
+                    }
+                    case ']':
+                    case '}': {
+                        if (--depth == 0) {
+                            close = po;
+                        }
+                        break;
+                    }
+                    case ',': {
+                        if (depth == 1 && po >= target) {
+                            ranges.push_back({begin, po, Json<Alloc>(), 0, false});
+                            begin = po + 1;
+                            target = po + chunk;
+                        }
+                        break;
+                    }
+                    default: {
+                        break;
                     }
-                    ptr[0] = 'f';
-                    ptr[1] = 'a';
-                    ptr[2] = 'l';
-                    ptr[3] = 's';
-                    ptr[4] = 'e';
                 }
-                break;
             }
-            case JsonType::Decimal: {
-                auto change = std::sprintf(ptr, "%lf", json.json.decimal);
-                if (change < 0) {
-                    return 0;
-                }
-                result += change;
-                break;
+        }
+        if (depth || !begin || data[close] != ']' || index.error_position != JsonStructuralIndex::no_error) {
+            return false;
+        }
+        ranges.push_back({begin, close, Json<Alloc>(), 0, false});
+        return ranges.size() > 1;
+    }
+
+    template <typename Alloc>
+    void JsonParallelParser<Alloc>::parseRange(Range& range) {
+        JsonDomBuilder<Alloc> builder(allocator, options);
+        JsonSaxParser<JsonDomBuilder<Alloc>> reader(data + range.begin, range.end - range.begin, builder);
+        range.parsed = reader.parseElements() && builder.take(range.elements);
+        range.error_position = range.begin + reader.position;
+    }
+
+    //malformed input is reparsed on one thread, so errors are reported exactly as objectify reports them
+    template <typename Alloc>
+    bool JsonParallelParser<Alloc>::parse(Json<Alloc>& json_ref) {
+        size_t threads = options.threads;
+        if (threads > size / min_range) {
+            threads = size / min_range;
+        }
+        bool parsed = false;
+        if (threads > 1 && split(threads)) {
+            std::vector<std::thread> workers;
+            for (size_t k = 1; k < ranges.size(); ++k) {
+                workers.emplace_back([this, k] { parseRange(ranges[k]); });
             }
-            case JsonType::Integer: {
-                auto change = std::sprintf(ptr, "%ld", json.json.integer);
-                if (change < 0) {
-                    return 0;
-                }
-                result += change;
-                break;
+            parseRange(ranges[0]);
+            for (auto &worker : workers) {
+                worker.join();
             }
-            case JsonType::Null: {
-                if ((result = 4) > s) {
-                    return 0;
+            parsed = true;
+            size_t count = 0;
+            for (auto &range : ranges) {
+                parsed = parsed && range.parsed;
+                count += range.elements.count;
+            }
+            if (parsed) {
+                JsonArray<Alloc> array(count, allocator);
+                for (auto &range : ranges) {
+                    array.append(reinterpret_cast<Json<Alloc> *>(range.elements.json.pointer), range.elements.count);
                 }
-                ptr[0] = 'n';
-                ptr[1] = 'u';
-                ptr[2] = 'l';
-                ptr[3] = 'l';
-                break;
+                json_ref = std::move(array);
             }
-            default:
-                break;
+            ranges.clear();
         }
-        return result;
+        if (parsed) {
+            return true;
+        }
+        JsonParser<Alloc> parser(data, size, allocator, options);
+        if (parser.parse(json_ref)) {
+            return true;
+        }
+        position = parser.position;
+        return false;
     }
-}
 
+    //runs handler over the text, error_position is set when the input is malformed or the handler stopped the parse
+    template <typename Handler, typename Ptr, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
+    bool parseSax(Handler& handler, const Ptr& ptr, const size_t& size, size_t& error_position) {
+        JsonSaxParser<Handler> reader(ptr, size, handler);
+        if (reader.parse()) {
+            return true;
+        }
+        error_position = reader.position;
+        return false;
+    }
+
+    template <typename Handler, typename Ptr, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
+    bool parseSax(Handler& handler, const Ptr& ptr, const size_t& size) {
+        size_t error_position;
+        return parseSax(handler, ptr, size, error_position);
+    }
+
+    template <typename Alloc, typename Ptr, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
+    bool objectify(Json<Alloc>& json_ref, const Ptr& ptr, const size_t& size, const ParseOptions& options, size_t& error_position) {
+        if (options.threads > 1 && std::allocator_traits<Alloc>::is_always_equal::value) {
+            JsonParallelParser<Alloc> parser(ptr, size, json_ref.allocator(), options);
+            if (parser.parse(json_ref)) {
+                return true;
+            }
+            error_position = parser.position;
+            return false;
+        }
+        JsonParser<Alloc> parser(ptr, size, json_ref.allocator(), options);
+        if (parser.parse(json_ref)) {
+            return true;
+        }
+        error_position = parser.position;
+        return false;
+    }
+
+    template <typename Alloc, typename Ptr, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
+    bool objectify(Json<Alloc>& json_ref, const Ptr& ptr, const size_t& size, size_t& error_position) {
+        return objectify(json_ref, ptr, size, ParseOptions(), error_position);
+    }
+
+    template <typename Alloc, typename Ptr, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
+    bool objectify(Json<Alloc>& json_ref, const Ptr& ptr, const size_t& size) {
+        size_t error_position;
+        return objectify(json_ref, ptr, size, error_position);
+    }
+}
@@ -0,0 +1,433 @@
+#pragma once
+#include "JsonPointer.h"
+#include <string>
+
+namespace Jsoncpp {
+    //RFC 6902 patches are Json arrays of operation objects. diff writes add, remove and replace, patch applies all six
+    //operations to a tree in place
+
+    enum class JsonPatchOp : uint8_t {
+        Add,
+        Remove,
+        Replace
+    };
+
+    //JsonPatchUndo class
+    //one applied change the other way round, op is done at pointer with value. Array pointers hold the index the
+    //change used, never "-"
+    template <typename Alloc = std::allocator<char>>
+    struct JsonPatchUndo {
+        JsonPatchOp op;
+        JsonPointer pointer;
+        Json<Alloc> value;
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //appends "/" and the token escaped as RFC 6901 wants it
+    inline void appendPointerToken(std::string& path, const std::string_view& token) {
+        path.push_back('/');
+        for (auto &ch : token) {
+            if (ch == '~') {
+                path.append("~0", 2);
+            }
+            else if (ch == '/') {
+                path.append("~1", 2);
+            }
+            else {
+                path.push_back(ch);
+            }
+        }
+    }
+
+    inline void appendPointerToken(std::string& path, size_t index) {
+        char buffer[20];
+        size_t length = 0;
+        do {
+            buffer[length++] = static_cast<char>('0' + index % 10);
+            index /= 10;
+        } while (index);
+        path.push_back('/');
+        while (length) {
+            path.push_back(buffer[--length]);
+        }
+    }
+
+    //nodes sharing a buffer are equal without looking further, strings and scalars are compared directly. Other
+    //containers are settled by their content hashes when both are cached, or when hashing is set, so a distinct pair is
+    //taken as equal only on a 64 bit collision. Without hashes false only means the pair has to be descended into
+    template <typename Alloc>
+    bool patchSame(const Json<Alloc>& source, const Json<Alloc>& target, const bool& hashing) {
+        if (source.type != target.type) {
+            return false;
+        }
+        if (source.type != JsonType::Array && source.type != JsonType::Object) {
+            return source == target;
+        }
+        if (source.count != target.count) {
+            return false;
+        }
+        if (source.json.pointer == target.json.pointer) {
+            return true;
+        }
+        if (hashing) {
+            return source.hash() == target.hash();
+        }
+        auto hash_value = source.cachedHash();
+        return hash_value && hash_value == target.cachedHash();
+    }
+
+    template <typename Alloc>
+    void pushPatchOperation(JsonArray<Alloc>& operations, const char *op, const std::string& path, const Json<Alloc> *value, const Alloc& allocator) {
+        JsonObject<Alloc> operation(value ? 3 : 2, allocator);
+        operation.insert(JsonString<Alloc>("op", allocator), JsonString<Alloc>(op, allocator));
+        operation.insert(JsonString<Alloc>("path", allocator), JsonString<Alloc>(path.data(), path.size(), allocator));
+        if (value) {
+            operation.insert(JsonString<Alloc>("value", allocator), *value);
+        }
+        operations.pushBack(std::move(operation));
+    }
+
+    //path is the pointer to source and target and is restored before returning. Values in the patch are copies of
+    //target nodes and so share their buffers. Hashes are only computed for array elements, which they line up, while
+    //a tree edited from a copy of the other shares every untouched subtree and is walked along the edited paths alone
+    template <typename Alloc>
+    void diff(const Json<Alloc>& source, const Json<Alloc>& target, std::string& path, JsonArray<Alloc>& operations) {
+        auto allocator = operations.allocator();
+        if (patchSame(source, target, false)) {
+            return;
+        }
+        if (source.type != target.type || (source.type != JsonType::Array && source.type != JsonType::Object)) {
+            pushPatchOperation(operations, "replace", path, &target, allocator);
+            return;
+        }
+        size_t base = path.size();
+        if (source.type == JsonType::Object) {
+            auto &from = *reinterpret_cast<const JsonObject<Alloc> *>(&source);
+            auto &to = *reinterpret_cast<const JsonObject<Alloc> *>(&target);
+            for (auto &slot : from) {
+                appendPointerToken(path, std::string_view(slot.key.data(), slot.key.length()));
+                auto value = to.at(slot.key);
+                if (value) {
+                    diff(slot.value, *value, path, operations);
+                }
+                else {
+                    pushPatchOperation<Alloc>(operations, "remove", path, nullptr, allocator);
+                }
+                path.resize(base);
+            }
+            for (auto &slot : to) {
+                if (!from.at(slot.key)) {
+                    appendPointerToken(path, std::string_view(slot.key.data(), slot.key.length()));
+                    pushPatchOperation(operations, "add", path, &slot.value, allocator);
+                    path.resize(base);
+                }
+            }
+            return;
+        }
+        //equal runs at both ends are dropped, so an element inserted or removed in the middle costs one operation
+        //instead of a replace for every element after it
+        auto from = reinterpret_cast<const Json<Alloc> *>(source.json.pointer);
+        auto to = reinterpret_cast<const Json<Alloc> *>(target.json.pointer);
+        size_t from_count = source.count;
+        size_t to_count = target.count;
+        size_t shorter = from_count < to_count ? from_count : to_count;
+        size_t prefix = 0;
+        while (prefix < shorter && patchSame(from[prefix], to[prefix], true)) {
+            ++prefix;
+        }
+        size_t suffix = 0;
+        while (suffix < shorter - prefix && patchSame(from[from_count - 1 - suffix], to[to_count - 1 - suffix], true)) {
+            ++suffix;
+        }
+        size_t from_middle = from_count - prefix - suffix;
+        size_t to_middle = to_count - prefix - suffix;
+        size_t k = 0;
+        for (; k < from_middle && k < to_middle; ++k) {
+            if (!patchSame(from[prefix + k], to[prefix + k], true)) {
+                appendPointerToken(path, prefix + k);
+                diff(from[prefix + k], to[prefix + k], path, operations);
+                path.resize(base);
+            }
+        }
+        for (; k < to_middle; ++k) {
+            appendPointerToken(path, prefix + k);
+            pushPatchOperation(operations, "add", path, to + prefix + k, allocator);
+            path.resize(base);
+        }
+        if (k < from_middle) {
+            appendPointerToken(path, prefix + k);
+            for (; k < from_middle; ++k) {
+                pushPatchOperation<Alloc>(operations, "remove", path, nullptr, allocator);
+            }
+            path.resize(base);
+        }
+    }
+
+    //a patch turning source into target, empty when they are equal. The operations are allocated with allocator
+    template <typename Alloc>
+    Json<Alloc> diff(const Json<Alloc>& source, const Json<Alloc>& target, const Alloc& allocator = Alloc()) {
+        JsonArray<Alloc> operations(0, allocator);
+        std::string path;
+        diff(source, target, path, operations);
+        return operations;
+    }
+
+    //pointer with its last token replaced by index
+    inline JsonPointer patchIndexPointer(const JsonPointer& pointer, const size_t& index) {
+        JsonPointer result(pointer);
+        auto &token = result.tokens.back();
+        token.key = std::to_string(index);
+        token.hash = JsonObject<>::hasher(std::string_view(token.key));
+        token.index = index;
+        return result;
+    }
+
+    template <typename Alloc>
+    bool patchAdd(Json<Alloc>& json_ref, const JsonPointer& pointer, const Json<Alloc>& value, std::vector<JsonPatchUndo<Alloc>> *undo) {
+        if (pointer.tokens.empty()) {
+            if (undo) {
+                undo->push_back({JsonPatchOp::Replace, pointer, std::move(json_ref)});
+            }
+            json_ref = value;
+            return true;
+        }
+        auto parent = pointer.evaluate(json_ref, pointer.tokens.size() - 1);
+        if (!parent) {
+            return false;
+        }
+        auto &token = pointer.tokens.back();
+        if (parent->type == JsonType::Object) {
+            auto &object = *reinterpret_cast<JsonObject<Alloc> *>(parent);
+            auto existing = object.at(token.key, token.hash);
+            if (existing) {
+                if (undo) {
+                    undo->push_back({JsonPatchOp::Replace, pointer, std::move(*existing)});
+                }
+                *existing = value;
+            }
+            else {
+                if (undo) {
+                    undo->push_back({JsonPatchOp::Remove, pointer, Json<Alloc>()});
+                }
+                object.insert(JsonString<Alloc>(token.key.data(), token.key.size(), parent->allocator()), value);
+            }
+            return true;
+        }
+        if (parent->type == JsonType::Array) {
+            auto &array = *reinterpret_cast<JsonArray<Alloc> *>(parent);
+            size_t index = token.key == "-" ? array.length() : token.index;
+            if (index > array.length()) {
+                return false;
+            }
+            if (undo) {
+                undo->push_back({JsonPatchOp::Remove, patchIndexPointer(pointer, index), Json<Alloc>()});
+            }
+            array.constructAt(index, value);
+            return true;
+        }
+        return false;
+    }
+
+    //the removed value is moved to removed when it is not null
+    template <typename Alloc>
+    bool patchRemove(Json<Alloc>& json_ref, const JsonPointer& pointer, Json<Alloc> *removed, std::vector<JsonPatchUndo<Alloc>> *undo) {
+        if (pointer.tokens.empty()) {
+            return false;
+        }
+        auto parent = pointer.evaluate(json_ref, pointer.tokens.size() - 1);
+        if (!parent) {
+            return false;
+        }
+        auto &token = pointer.tokens.back();
+        Json<Alloc> *value = nullptr;
+        if (parent->type == JsonType::Object) {
+            value = reinterpret_cast<JsonObject<Alloc> *>(parent)->at(token.key, token.hash);
+        }
+        else if (parent->type == JsonType::Array && token.index < parent->count) {
+            value = &(*reinterpret_cast<JsonArray<Alloc> *>(parent))[token.index];
+        }
+        if (!value) {
+            return false;
+        }
+        if (removed) {
+            *removed = std::move(*value);
+        }
+        if (undo) {
+            undo->push_back({JsonPatchOp::Add, pointer, removed ? *removed : std::move(*value)});
+        }
+        if (parent->type == JsonType::Object) {
+            return reinterpret_cast<JsonObject<Alloc> *>(parent)->erase(JsonString<Alloc>(json_borrow, token.key.data(), token.key.size(), parent->allocator()));
+        }
+        return reinterpret_cast<JsonArray<Alloc> *>(parent)->erase(token.index);
+    }
+
+    template <typename Alloc>
+    bool patchReplace(Json<Alloc>& json_ref, const JsonPointer& pointer, const Json<Alloc>& value, std::vector<JsonPatchUndo<Alloc>> *undo) {
+        auto target = pointer.evaluate(json_ref);
+        if (!target) {
+            return false;
+        }
+        if (undo) {
+            undo->push_back({JsonPatchOp::Replace, pointer, std::move(*target)});
+        }
+        *target = value;
+        return true;
+    }
+
+    template <typename Alloc>
+    const Json<Alloc> *patchMember(const JsonObject<Alloc>& operation, const char *name, const JsonType& type = JsonType::Null) {
+        std::string_view key(name);
+        auto value = operation.at(key, JsonObject<Alloc>::hasher(key));
+        return value && (type == JsonType::Null || value->type == type) ? value : nullptr;
+    }
+
+    template <typename Alloc>
+    inline std::string_view patchView(const Json<Alloc>& string) {
+        auto &s = *reinterpret_cast<const JsonString<Alloc> *>(&string);
+        return std::string_view(s.data(), s.length());
+    }
+
+    //equality as RFC 6902 test defines it: numbers are equal by value whether they are integers or decimals, arrays and
+    //objects are compared member by member so that holds inside them too
+    template <typename Alloc>
+    bool patchEqual(const Json<Alloc>& source, const Json<Alloc>& target) {
+        if (source.type == JsonType::Integer && target.type == JsonType::Decimal) {
+            return patchEqual(target, source);
+        }
+        if (source.type == JsonType::Decimal && target.type == JsonType::Integer) {
+            double value = source.json.decimal;
+            return value >= -9223372036854775808.0 && value < 9223372036854775808.0 && static_cast<double>(static_cast<long>(value)) == value && static_cast<long>(value) == target.json.integer;
+        }
+        if (source.type != target.type || (source.type != JsonType::Array && source.type != JsonType::Object)) {
+            return source == target;
+        }
+        if (source.count != target.count) {
+            return false;
+        }
+        if (source.type == JsonType::Array) {
+            auto from = reinterpret_cast<const Json<Alloc> *>(source.json.pointer);
+            auto to = reinterpret_cast<const Json<Alloc> *>(target.json.pointer);
+            for (size_t k = 0; k < source.count; ++k) {
+                if (!patchEqual(from[k], to[k])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        auto &to = *reinterpret_cast<const JsonObject<Alloc> *>(&target);
+        for (auto &slot : *reinterpret_cast<const JsonObject<Alloc> *>(&source)) {
+            auto value = to.at(slot.key);
+            if (!value || !patchEqual(slot.value, *value)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //every change made is logged to undo, also when a later step of the same operation fails
+    template <typename Alloc>
+    bool patchOperation(Json<Alloc>& json_ref, const Json<Alloc>& operation, std::vector<JsonPatchUndo<Alloc>>& undo) {
+        if (operation.type != JsonType::Object) {
+            return false;
+        }
+        auto &members = *reinterpret_cast<const JsonObject<Alloc> *>(&operation);
+        auto op = patchMember(members, "op", JsonType::String);
+        auto path = patchMember(members, "path", JsonType::String);
+        if (!op || !path) {
+            return false;
+        }
+        JsonPointer pointer(patchView(*path));
+        if (!pointer.valid) {
+            return false;
+        }
+        auto name = patchView(*op);
+        if (name == "add" || name == "replace" || name == "test") {
+            auto value = patchMember(members, "value");
+            if (!value) {
+                return false;
+            }
+            if (name == "add") {
+                return patchAdd(json_ref, pointer, *value, &undo);
+            }
+            if (name == "replace") {
+                return patchReplace(json_ref, pointer, *value, &undo);
+            }
+            auto target = pointer.evaluate(static_cast<const Json<Alloc> &>(json_ref));
+            return target && patchEqual(*target, *value);
+        }
+        if (name == "remove") {
+            return patchRemove<Alloc>(json_ref, pointer, nullptr, &undo);
+        }
+        if (name == "move" || name == "copy") {
+            auto from = patchMember(members, "from", JsonType::String);
+            if (!from) {
+                return false;
+            }
+            JsonPointer source(patchView(*from));
+            if (!source.valid) {
+                return false;
+            }
+            Json<Alloc> value;
+            if (name == "copy") {
+                auto found = source.evaluate(static_cast<const Json<Alloc> &>(json_ref));
+                if (!found) {
+                    return false;
+                }
+                value = *found;
+                return patchAdd(json_ref, pointer, value, &undo);
+            }
+            //a value cannot be moved into one of its own children
+            if (source.tokens.size() < pointer.tokens.size() && std::equal(source.tokens.begin(), source.tokens.end(), pointer.tokens.begin(), [](const JsonPointer::Token& a, const JsonPointer::Token& b) {
+                return a.key == b.key;
+            })) {
+                return false;
+            }
+            return patchRemove(json_ref, source, &value, &undo) && patchAdd(json_ref, pointer, value, &undo);
+        }
+        return false;
+    }
+
+    //applies every operation or none. Each change logs its inverse, removed and replaced values are kept by moving
+    //them into the log, and a failed operation undoes the log from the back, so the tree is never copied.
+    //error_index is the failed operation
+    template <typename Alloc>
+    bool patch(Json<Alloc>& json_ref, const Json<Alloc>& operations, size_t& error_index) {
+        error_index = 0;
+        if (operations.type != JsonType::Array) {
+            return false;
+        }
+        std::vector<JsonPatchUndo<Alloc>> undo;
+        auto &list = *reinterpret_cast<const JsonArray<Alloc> *>(&operations);
+        for (size_t k = 0; k < list.length(); ++k) {
+            if (!patchOperation(json_ref, list[k], undo)) {
+                for (; !undo.empty(); undo.pop_back()) {
+                    auto &change = undo.back();
+                    switch (change.op) {
+                        case JsonPatchOp::Add: {
+                            patchAdd<Alloc>(json_ref, change.pointer, change.value, nullptr);
+                            break;
+                        }
+                        case JsonPatchOp::Remove: {
+                            patchRemove<Alloc>(json_ref, change.pointer, nullptr, nullptr);
+                            break;
+                        }
+                        case JsonPatchOp::Replace: {
+                            patchReplace<Alloc>(json_ref, change.pointer, change.value, nullptr);
+                            break;
+                        }
+                    }
+                }
+                error_index = k;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename Alloc>
+    bool patch(Json<Alloc>& json_ref, const Json<Alloc>& operations) {
+        size_t error_index;
+        return patch(json_ref, operations, error_index);
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include "JsonDocumentView.h"
+#include <vector>
+
+namespace Jsoncpp {
+    //JsonPointer class
+    //an RFC 6901 pointer parsed once: every reference token is unescaped, hashed with JsonHash and, when it spells an
+    //array index, converted to one. Evaluating never allocates or hashes. The empty pointer refers to the whole
+    //document, a pointer that failed to compile finds nothing
+    struct JsonPointer {
+        static constexpr size_t no_index = SIZE_MAX;
+
+        struct Token {
+            std::string key;
+            size_t hash;
+            size_t index;
+        };
+
+        std::vector<Token> tokens;
+        bool valid = true;
+
+        JsonPointer() = default;
+        JsonPointer(const std::string_view& pointer);
+        bool compile(const std::string_view& pointer);
+        template <typename Alloc>
+        Json<Alloc> *evaluate(Json<Alloc>& root) const;
+        template <typename Alloc>
+        Json<Alloc> *evaluate(Json<Alloc>& root, const size_t& depth) const;
+        template <typename Alloc>
+        const Json<Alloc> *evaluate(const Json<Alloc>& root) const;
+        JsonDocumentView evaluate(const JsonDocumentView& root) const;
+        template <typename Alloc>
+        void evaluate(const std::vector<Json<Alloc>>& documents, std::vector<const Json<Alloc> *>& results) const;
+        void evaluate(const std::vector<std::string_view>& documents, std::vector<JsonDocumentView>& results) const;
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //"0" or digits without a leading zero, anything else (including "-", the element past the end) is no_index
+    inline size_t pointerIndex(const std::string_view& token) {
+        if (token.empty() || (token.size() > 1 && token[0] == '0')) {
+            return JsonPointer::no_index;
+        }
+        size_t result = 0;
+        for (auto &ch : token) {
+            if (!isDigit(ch) || result > (JsonPointer::no_index - 1 - (ch - '0')) / 10) {
+                return JsonPointer::no_index;
+            }
+            result = result * 10 + (ch - '0');
+        }
+        return result;
+    }
+
+    //JsonPointer class member function
+
+    inline JsonPointer::JsonPointer(const std::string_view& pointer) {
+        compile(pointer);
+    }
+
+    //~1 decodes to '/' and ~0 to '~', any other '~' makes the pointer invalid
+    inline bool JsonPointer::compile(const std::string_view& pointer) {
+        tokens.clear();
+        valid = pointer.empty() || pointer[0] == '/';
+        for (size_t po = 1; valid && po <= pointer.size();) {
+            size_t end = pointer.find('/', po);
+            if (end == std::string_view::npos) {
+                end = pointer.size();
+            }
+            std::string key;
+            key.reserve(end - po);
+            for (size_t k = po; k < end; ++k) {
+                if (pointer[k] != '~') {
+                    key.push_back(pointer[k]);
+                }
+                else if (k + 1 < end && (pointer[k + 1] == '0' || pointer[k + 1] == '1')) {
+                    key.push_back(pointer[++k] == '0' ? '~' : '/');
+                }
+                else {
+                    valid = false;
+                    break;
+                }
+            }
+            auto hash = JsonObject<>::hasher(std::string_view(key));
+            auto index = pointerIndex(key);
+            tokens.push_back({std::move(key), hash, index});
+            po = end + 1;
+        }
+        if (!valid) {
+            tokens.clear();
+        }
+        return valid;
+    }
+
+    template <typename Alloc>
+    const Json<Alloc>* JsonPointer::evaluate(const Json<Alloc>& root) const {
+        if (!valid) {
+            return nullptr;
+        }
+        auto cur = &root;
+        for (auto &token : tokens) {
+            switch (cur->type) {
+                case JsonType::Object: {
+                    cur = reinterpret_cast<const JsonObject<Alloc> *>(cur)->at(token.key, token.hash);
+                    break;
+                }
+                case JsonType::Array: {
+                    cur = token.index < cur->count ? reinterpret_cast<const Json<Alloc> *>(cur->json.pointer) + token.index : nullptr;
+                    break;
+                }
+                default: {
+                    return nullptr;
+                }
+            }
+            if (!cur) {
+                return nullptr;
+            }
+        }
+        return cur;
+    }
+
+    //every container on the way is detached, so the result can be written without touching copies of root
+    template <typename Alloc>
+    inline Json<Alloc>* JsonPointer::evaluate(Json<Alloc>& root) const {
+        return evaluate(root, tokens.size());
+    }
+
+    //follows only the first depth tokens, depth = tokens.size() - 1 gives the container the last token is looked up in
+    template <typename Alloc>
+    Json<Alloc>* JsonPointer::evaluate(Json<Alloc>& root, const size_t& depth) const {
+        if (!valid || depth > tokens.size()) {
+            return nullptr;
+        }
+        auto cur = &root;
+        for (size_t k = 0; k < depth; ++k) {
+            auto &token = tokens[k];
+            switch (cur->type) {
+                case JsonType::Object: {
+                    cur = reinterpret_cast<JsonObject<Alloc> *>(cur)->at(token.key, token.hash);
+                    break;
+                }
+                case JsonType::Array: {
+                    cur = token.index < cur->count ? &(*reinterpret_cast<JsonArray<Alloc> *>(cur))[token.index] : nullptr;
+                    break;
+                }
+                default: {
+                    return nullptr;
+                }
+            }
+            if (!cur) {
+                return nullptr;
+            }
+        }
+        return cur;
+    }
+
+    //walks raw text with the skipping scanner of JsonDocumentView, escapes in a key are decoded while it is compared
+    //and keys without any are compared in place
+    inline JsonDocumentView JsonPointer::evaluate(const JsonDocumentView& root) const {
+        if (!valid) {
+            return JsonDocumentView();
+        }
+        auto cur = root;
+        for (auto &token : tokens) {
+            if (!cur) {
+                break;
+            }
+            if (cur.data[cur.position] == '[') {
+                cur = token.index == no_index ? JsonDocumentView() : cur.at(token.index);
+            }
+            else {
+                cur = cur.at(std::string_view(token.key));
+            }
+        }
+        return cur;
+    }
+
+    //results[k] is the value in documents[k] or nullptr
+    template <typename Alloc>
+    void JsonPointer::evaluate(const std::vector<Json<Alloc>>& documents, std::vector<const Json<Alloc> *>& results) const {
+        results.resize(documents.size());
+        for (size_t k = 0; k < documents.size(); ++k) {
+            results[k] = evaluate(documents[k]);
+        }
+    }
+
+    inline void JsonPointer::evaluate(const std::vector<std::string_view>& documents, std::vector<JsonDocumentView>& results) const {
+        results.resize(documents.size());
+        for (size_t k = 0; k < documents.size(); ++k) {
+            results[k] = evaluate(JsonDocumentView(documents[k].data(), documents[k].size()));
+        }
+    }
+}
@@ -0,0 +1,675 @@
+#pragma once
+#include "JsonClass.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/uio.h>
+#include <climits>
+#include <cerrno>
+#define JSONCPP_POSIX 1
+#endif
+
+namespace Jsoncpp {
+    //a sink is anything with put(const char&) and write(const_char_ptr, const size_t&)
+
+    //JsonStringSink class
+    struct JsonStringSink {
+        std::string &output;
+
+        JsonStringSink(std::string &s);
+        void put(const char& ch);
+        void write(const_char_ptr ptr, const size_t& size);
+    };
+
+    //JsonBufferSink class
+    //writes into a fixed buffer, everything past the end is counted but dropped
+    struct JsonBufferSink {
+        char_ptr pointer;
+        size_t capacity;
+        size_t length = 0;
+
+        JsonBufferSink(char_ptr ptr, const size_t& s);
+        void put(const char& ch);
+        void write(const_char_ptr ptr, const size_t& size);
+        bool overflow() const;
+    };
+
+    //JsonCountingSink class
+    struct JsonCountingSink {
+        size_t length = 0;
+
+        void put(const char& ch);
+        void write(const_char_ptr ptr, const size_t& size);
+    };
+
+    //JsonChunkedSink class
+    //fixed size chunks, output already written is never moved
+    struct JsonChunkedSink {
+        static constexpr size_t default_chunk_size = 64 * 1024;
+
+        std::vector<std::string> chunks;
+        size_t chunk_size;
+
+        JsonChunkedSink(const size_t& s = default_chunk_size);
+        void put(const char& ch);
+        void write(const_char_ptr ptr, const size_t& size);
+        size_t size() const;
+        std::string str() const;
+    };
+
+#ifdef JSONCPP_POSIX
+    //JsonFdSink class
+    //buffers output and hands it to write(2) one block at a time
+    struct JsonFdSink {
+        static constexpr size_t default_block_size = 64 * 1024;
+
+        int fd;
+        std::unique_ptr<char[]> buffer;
+        size_t capacity;
+        size_t used = 0;
+        bool failed = false;
+
+        JsonFdSink(const int& f, const size_t& block_size = default_block_size);
+        JsonFdSink(const JsonFdSink &other) = delete;
+        JsonFdSink &operator=(const JsonFdSink &other) = delete;
+        ~JsonFdSink();
+        void put(const char& ch);
+        void write(const_char_ptr ptr, const size_t& size);
+        bool flush();
+        bool writeAll(const_char_ptr ptr, size_t size);
+    };
+#endif
+
+    //JsonParallelSerializer class
+    //cuts the tree into pieces that threads serialize into their own buffers, the buffers are then written out in
+    //order so the output is byte for byte what serialize() writes. A container with enough children is cut into runs
+    //of children, a smaller one is opened up so that a large container under it can be cut instead. Threads take the
+    //next unclaimed piece, so a few expensive runs do not hold up the rest
+    template <typename Alloc = std::allocator<char>>
+    struct JsonParallelSerializer {
+        static constexpr size_t pieces_per_thread = 8;
+        static constexpr size_t max_open_depth = 4;
+
+        enum class PieceType : uint8_t {
+            Text, Value, Elements, Members
+        };
+
+        //Elements covers array elements [begin, end), Members covers object slots [begin, end) whose first entry is
+        //entry number first of the object
+        struct Piece {
+            PieceType type;
+            const Json<Alloc> *json;
+            size_t begin;
+            size_t end;
+            size_t first;
+            std::string output;
+        };
+
+        size_t threads;
+        std::vector<Piece> pieces;
+        std::atomic<size_t> next{0};
+
+        JsonParallelSerializer(const size_t& t);
+        void run(const Json<Alloc>& json);
+        void plan(const Json<Alloc>& json, const size_t& depth);
+        void text(const_char_ptr ptr, const size_t& size);
+        void work();
+        void writePiece(Piece& piece);
+        size_t size() const;
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //JsonStringSink class member function
+
+    inline JsonStringSink::JsonStringSink(std::string &s) : output(s) {}
+
+    inline void JsonStringSink::put(const char& ch) {
+        output.push_back(ch);
+    }
+
+    inline void JsonStringSink::write(const_char_ptr ptr, const size_t& size) {
+        output.append(ptr, size);
+    }
+
+    //JsonBufferSink class member function
+
+    inline JsonBufferSink::JsonBufferSink(char_ptr ptr, const size_t& s) : pointer(ptr), capacity(s) {}
+
+    inline void JsonBufferSink::put(const char& ch) {
+        if (length < capacity) {
+            pointer[length] = ch;
+        }
+        ++length;
+    }
+
+    inline void JsonBufferSink::write(const_char_ptr ptr, const size_t& size) {
+        if (size && length < capacity) {
+            std::memcpy(pointer + length, ptr, size < capacity - length ? size : capacity - length);
+        }
+        length += size;
+    }
+
+    inline bool JsonBufferSink::overflow() const {
+        return length > capacity;
+    }
+
+    //JsonCountingSink class member function
+
+    inline void JsonCountingSink::put(const char&) {
+        ++length;
+    }
+
+    inline void JsonCountingSink::write(const_char_ptr, const size_t& size) {
+        length += size;
+    }
+
+    //JsonChunkedSink class member function
+
+    inline JsonChunkedSink::JsonChunkedSink(const size_t& s) : chunk_size(s) {}
+
+    inline void JsonChunkedSink::put(const char& ch) {
+        if (chunks.empty() || chunks.back().size() == chunk_size) {
+            chunks.emplace_back();
+            chunks.back().reserve(chunk_size);
+        }
+        chunks.back().push_back(ch);
+    }
+
+    inline void JsonChunkedSink::write(const_char_ptr ptr, const size_t& size) {
+        size_t written = 0;
+        while (written < size) {
+            if (chunks.empty() || chunks.back().size() == chunk_size) {
+                chunks.emplace_back();
+                chunks.back().reserve(chunk_size);
+            }
+            auto &chunk = chunks.back();
+            size_t num = chunk_size - chunk.size();
+            if (num > size - written) {
+                num = size - written;
+            }
+            chunk.append(ptr + written, num);
+            written += num;
+        }
+    }
+
+    inline size_t JsonChunkedSink::size() const {
+        size_t result = 0;
+        for (auto &chunk : chunks) {
+            result += chunk.size();
+        }
+        return result;
+    }
+
+    inline std::string JsonChunkedSink::str() const {
+        std::string result;
+        result.reserve(size());
+        for (auto &chunk : chunks) {
+            result += chunk;
+        }
+        return result;
+    }
+
+#ifdef JSONCPP_POSIX
+    //JsonFdSink class member function
+
+    inline JsonFdSink::JsonFdSink(const int& f, const size_t& block_size)
+    : fd(f), buffer(new char[block_size]), capacity(block_size) {}
+
+    inline JsonFdSink::~JsonFdSink() {
+        flush();
+    }
+
+    inline void JsonFdSink::put(const char& ch) {
+        if (used == capacity) {
+            flush();
+        }
+        buffer[used++] = ch;
+    }
+
+    inline void JsonFdSink::write(const_char_ptr ptr, const size_t& size) {
+        if (used + size <= capacity) {
+            if (!size) {
+                return;
+            }
+            std::memcpy(buffer.get() + used, ptr, size);
+            used += size;
+            return;
+        }
+        flush();
+        if (size >= capacity) {
+            writeAll(ptr, size);
+            return;
+        }
+        std::memcpy(buffer.get(), ptr, size);
+        used = size;
+    }
+
+    inline bool JsonFdSink::flush() {
+        bool result = writeAll(buffer.get(), used);
+        used = 0;
+        return result;
+    }
+
+    inline bool JsonFdSink::writeAll(const_char_ptr ptr, size_t size) {
+        while (size && !failed) {
+            auto change = ::write(fd, ptr, size);
+            if (change < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                failed = true;
+                break;
+            }
+            ptr += change;
+            size -= change;
+        }
+        return !failed;
+    }
+#endif
+
+    constexpr char escapeCharacter(const char& ch) {
+        switch (ch) {
+            case '"': return '"';
+            case '\\': return '\\';
+            case '\b': return 'b';
+            case '\f': return 'f';
+            case '\n': return 'n';
+            case '\r': return 'r';
+            case '\t': return 't';
+            default: return 0;
+        }
+    }
+
+    constexpr size_t max_integer_length = 20;
+    constexpr size_t max_decimal_length = 32;
+
+    constexpr char digit_pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    inline size_t countDigits(const unsigned long& value) {
+        size_t result = 1;
+        for (unsigned long k = 10; k <= value && result < 20; k *= 10) {
+            ++result;
+        }
+        return result;
+    }
+
+    //des must hold max_integer_length bytes, returns the number of bytes written
+    inline size_t writeInteger(char_ptr des, const long& value) {
+        unsigned long magnitude = value < 0 ? 0UL - static_cast<unsigned long>(value) : static_cast<unsigned long>(value);
+        size_t sign = value < 0;
+        size_t length = sign + countDigits(magnitude);
+        des[0] = '-';
+        char_ptr cur = des + length;
+        while (magnitude >= 100) {
+            auto pair = (magnitude % 100) * 2;
+            magnitude /= 100;
+            *--cur = digit_pairs[pair + 1];
+            *--cur = digit_pairs[pair];
+        }
+        if (magnitude >= 10) {
+            *--cur = digit_pairs[magnitude * 2 + 1];
+            *--cur = digit_pairs[magnitude * 2];
+        }
+        else {
+            *--cur = static_cast<char>('0' + magnitude);
+        }
+        return length;
+    }
+
+    //shortest text that parses back to the same double, always with a fraction or exponent so it reads back as a
+    //Decimal. JSON has no spelling for inf and nan, they become null. des must hold max_decimal_length bytes
+    inline size_t writeDecimal(char_ptr des, const double& value) {
+        if (value != value || value - value != 0) {
+            std::memcpy(des, "null", 4);
+            return 4;
+        }
+        auto result = std::to_chars(des, des + max_decimal_length - 2, value);
+        size_t length = result.ptr - des;
+        for (size_t k = 0; k < length; ++k) {
+            if (des[k] == '.' || des[k] == 'e') {
+                return length;
+            }
+        }
+        des[length++] = '.';
+        des[length++] = '0';
+        return length;
+    }
+
+    //unescaped runs are handed to the sink in one write
+    template <typename Sink>
+    void writeEscaped(Sink& sink, const_char_ptr src, const size_t& length) {
+        constexpr char hex_digits[] = "0123456789abcdef";
+        size_t pre = 0;
+        for (size_t k = 0; k < length; ++k) {
+            auto &ch = src[k];
+            auto escaped = escapeCharacter(ch);
+            if (!escaped && static_cast<unsigned char>(ch) >= 0x20) {
+                continue;
+            }
+            sink.write(src + pre, k - pre);
+            pre = k + 1;
+            if (escaped) {
+                char temp[2] = {'\\', escaped};
+                sink.write(temp, 2);
+            }
+            else {
+                char temp[6] = {'\\', 'u', '0', '0', hex_digits[ch >> 4], hex_digits[ch & 0xF]};
+                sink.write(temp, 6);
+            }
+        }
+        sink.write(src + pre, length - pre);
+    }
+
+    template <typename Alloc, typename Sink>
+    void serialize(const Json<Alloc>& json, Sink& sink) {
+        switch (json.type) {
+            case JsonType::String: {
+                auto &s = *reinterpret_cast<const JsonString<Alloc> *>(&json);
+                sink.put('"');
+                writeEscaped(sink, s.data(), s.length());
+                sink.put('"');
+                break;
+            }
+            case JsonType::Object: {
+                sink.put('{');
+                bool not_first = false;
+                for (auto &cur : *reinterpret_cast<const JsonObject<Alloc> *>(&json)) {
+                    if (not_first) {
+                        sink.put(',');
+                    }
+                    serialize(cur.key, sink);
+                    sink.put(':');
+                    serialize(cur.value, sink);
+                    not_first = true;
+                }
+                sink.put('}');
+                break;
+            }
+            case JsonType::Array: {
+                sink.put('[');
+                auto data_ptr = reinterpret_cast<const Json<Alloc> *>(json.json.pointer);
+                for (size_t k = 0; k < json.count; ++k) {
+                    if (k) {
+                        sink.put(',');
+                    }
+                    serialize(data_ptr[k], sink);
+                }
+                sink.put(']');
+                break;
+            }
+            case JsonType::Boolean: {
+                if (json.json.boolean) {
+                    sink.write("true", 4);
+                }
+                else {
+                    sink.write("false", 5);
+                }
+                break;
+            }
+            case JsonType::Decimal: {
+                char buffer[max_decimal_length];
+                sink.write(buffer, writeDecimal(buffer, json.json.decimal));
+                break;
+            }
+            case JsonType::Integer: {
+                char buffer[max_integer_length];
+                sink.write(buffer, writeInteger(buffer, json.json.integer));
+                break;
+            }
+            case JsonType::Null: {
+                sink.write("null", 4);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    template <typename Alloc>
+    std::string serialize(const Json<Alloc>& json) {
+        std::string result;
+        JsonStringSink sink(result);
+        serialize(json, sink);
+        return result;
+    }
+
+    template <typename Alloc>
+    size_t serializedSize(const Json<Alloc>& json) {
+        JsonCountingSink sink;
+        serialize(json, sink);
+        return sink.length;
+    }
+
+    //returns the number of bytes written, 0 if the output does not fit in s bytes
+    template <typename Alloc, typename Ptr>
+    size_t toString(const Json<Alloc>& json, Ptr ptr, const size_t& s) {
+        JsonBufferSink sink(ptr, s);
+        serialize(json, sink);
+        if (sink.overflow()) {
+            return 0;
+        }
+        return sink.length;
+    }
+
+    //JsonParallelSerializer class member function
+
+    template <typename Alloc>
+    inline JsonParallelSerializer<Alloc>::JsonParallelSerializer(const size_t& t) : threads(t ? t : 1) {}
+
+    //consecutive text is merged into one piece
+    template <typename Alloc>
+    void JsonParallelSerializer<Alloc>::text(const_char_ptr ptr, const size_t& size) {
+        if (pieces.empty() || pieces.back().type != PieceType::Text) {
+            pieces.push_back({PieceType::Text, nullptr, 0, 0, 0, std::string()});
+        }
+        pieces.back().output.append(ptr, size);
+    }
+
+    template <typename Alloc>
+    void JsonParallelSerializer<Alloc>::plan(const Json<Alloc>& json, const size_t& depth) {
+        size_t runs = threads * pieces_per_thread;
+        bool container = json.type == JsonType::Array || json.type == JsonType::Object;
+        if (!container || depth == max_open_depth || !json.count) {
+            pieces.push_back({PieceType::Value, &json, 0, 0, 0, std::string()});
+            return;
+        }
+        if (json.type == JsonType::Array) {
+            text("[", 1);
+            if (json.count >= runs) {
+                for (size_t k = 0; k < runs; ++k) {
+                    pieces.push_back({PieceType::Elements, &json, json.count * k / runs, json.count * (k + 1) / runs, 0, std::string()});
+                }
+            }
+            else {
+                auto elements = reinterpret_cast<const Json<Alloc> *>(json.json.pointer);
+                for (size_t k = 0; k < json.count; ++k) {
+                    if (k) {
+                        text(",", 1);
+                    }
+                    plan(elements[k], depth + 1);
+                }
+            }
+            text("]", 1);
+            return;
+        }
+        auto &object = *reinterpret_cast<const JsonObject<Alloc> *>(&json);
+        text("{", 1);
+        if (json.count >= runs) {
+            //cuts by entries rather than slots, so every run knows whether it needs a leading comma
+            auto ctrl = object.control();
+            size_t capacity = object.capacity();
+            size_t begin = 0;
+            size_t entries = 0;
+            size_t first = 0;
+            size_t run = 1;
+            for (size_t k = 0; k < capacity; ++k) {
+                if (ctrl[k] >= 0 && ++entries == json.count * run / runs && run < runs) {
+                    pieces.push_back({PieceType::Members, &json, begin, k + 1, first, std::string()});
+                    begin = k + 1;
+                    first = entries;
+                    ++run;
+                }
+            }
+            pieces.push_back({PieceType::Members, &json, begin, capacity, first, std::string()});
+        }
+        else {
+            bool not_first = false;
+            for (auto &cur : object) {
+                std::string key;
+                JsonStringSink sink(key);
+                if (not_first) {
+                    sink.put(',');
+                }
+                serialize(cur.key, sink);
+                sink.put(':');
+                text(key.data(), key.size());
+                plan(cur.value, depth + 1);
+                not_first = true;
+            }
+        }
+        text("}", 1);
+    }
+
+    template <typename Alloc>
+    void JsonParallelSerializer<Alloc>::writePiece(Piece& piece) {
+        JsonStringSink sink(piece.output);
+        switch (piece.type) {
+            case PieceType::Value: {
+                serialize(*piece.json, sink);
+                break;
+            }
+            case PieceType::Elements: {
+                auto elements = reinterpret_cast<const Json<Alloc> *>(piece.json->json.pointer);
+                for (size_t k = piece.begin; k < piece.end; ++k) {
+                    if (k) {
+                        sink.put(',');
+                    }
+                    serialize(elements[k], sink);
+                }
+                break;
+            }
+            case PieceType::Members: {
+                auto &object = *reinterpret_cast<const JsonObject<Alloc> *>(piece.json);
+                using iterator = typename JsonObject<Alloc>::const_iterator;
+                size_t entry = piece.first;
+                for (iterator it(object.control(), object.slots(), piece.begin, piece.end), end(nullptr, nullptr, piece.end, piece.end); it != end; ++it) {
+                    if (entry++) {
+                        sink.put(',');
+                    }
+                    serialize(it->key, sink);
+                    sink.put(':');
+                    serialize(it->value, sink);
+                }
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+
+    template <typename Alloc>
+    void JsonParallelSerializer<Alloc>::work() {
+        for (size_t k = next.fetch_add(1); k < pieces.size(); k = next.fetch_add(1)) {
+            writePiece(pieces[k]);
+        }
+    }
+
+    template <typename Alloc>
+    void JsonParallelSerializer<Alloc>::run(const Json<Alloc>& json) {
+        pieces.clear();
+        next = 0;
+        plan(json, 0);
+        std::vector<std::thread> workers;
+        for (size_t k = 1; k < threads; ++k) {
+            workers.emplace_back([this] { work(); });
+        }
+        work();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+    template <typename Alloc>
+    size_t JsonParallelSerializer<Alloc>::size() const {
+        size_t result = 0;
+        for (auto &piece : pieces) {
+            result += piece.output.size();
+        }
+        return result;
+    }
+
+    template <typename Alloc, typename Sink>
+    void serializeParallel(const Json<Alloc>& json, Sink& sink, const size_t& threads) {
+        JsonParallelSerializer<Alloc> serializer(threads);
+        serializer.run(json);
+        for (auto &piece : serializer.pieces) {
+            sink.write(piece.output.data(), piece.output.size());
+        }
+    }
+
+    //the pieces are copied into the result in one pass once its final size is known
+    template <typename Alloc>
+    std::string serializeParallel(const Json<Alloc>& json, const size_t& threads) {
+        JsonParallelSerializer<Alloc> serializer(threads);
+        serializer.run(json);
+        std::string result(serializer.size(), '\0');
+        size_t length = 0;
+        for (auto &piece : serializer.pieces) {
+            std::memcpy(result.data() + length, piece.output.data(), piece.output.size());
+            length += piece.output.size();
+        }
+        return result;
+    }
+
+#ifdef JSONCPP_POSIX
+    //hands the pieces to writev(2) directly, IOV_MAX at a time
+    template <typename Alloc>
+    bool writeParallel(const Json<Alloc>& json, const int& fd, const size_t& threads) {
+        JsonParallelSerializer<Alloc> serializer(threads);
+        serializer.run(json);
+        std::vector<iovec> vectors;
+        for (auto &piece : serializer.pieces) {
+            if (piece.output.size()) {
+                vectors.push_back({const_cast<char_ptr>(piece.output.data()), piece.output.size()});
+            }
+        }
+        size_t k = 0;
+        while (k < vectors.size()) {
+            int num = static_cast<int>(vectors.size() - k < IOV_MAX ? vectors.size() - k : IOV_MAX);
+            auto change = ::writev(fd, vectors.data() + k, num);
+            if (change < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            //a short write leaves the rest of the current vector for the next call
+            size_t written = static_cast<size_t>(change);
+            while (k < vectors.size() && written >= vectors[k].iov_len) {
+                written -= vectors[k++].iov_len;
+            }
+            if (written) {
+                vectors[k].iov_base = static_cast<char_ptr>(vectors[k].iov_base) + written;
+                vectors[k].iov_len -= written;
+            }
+        }
+        return true;
+    }
+#endif
+}
@@ -0,0 +1,356 @@
+#pragma once
+#include "JsonParser.h"
+
+namespace Jsoncpp {
+    enum class JsonStreamStatus {
+        NeedMore, Done, Error
+    };
+
+    //JsonStreamParser class
+    //push parser for input that arrives in pieces: feed() takes chunks split anywhere, inside strings, numbers and
+    //literals included, and only keeps the unfinished token, the open containers and the values under them. finish()
+    //marks the end of input, which is needed to end a top level number
+    template <typename Alloc = std::allocator<char>>
+    struct JsonStreamParser {
+        enum class State : uint8_t {
+            Value, FirstElement, FirstKey, Key, Colon, Next, String, Number, Literal, Done, Error
+        };
+
+        State state = State::Value;
+        bool is_key = false;
+        bool escape_pending = false;
+        std::string token;
+        std::string scratch;
+        std::vector<JsonType> frames;
+        JsonDomBuilder<Alloc> builder;
+        size_t consumed = 0;
+        size_t error_position = 0;
+
+        JsonStreamParser(const Alloc& a = Alloc(), const ParseOptions& o = ParseOptions());
+        JsonStreamStatus feed(const_char_ptr ptr, const size_t& size);
+        JsonStreamStatus finish();
+        JsonStreamStatus status() const;
+        bool take(Json<Alloc>& json_ref);
+        void reset();
+        bool step(const char& ch);
+        bool endString(const size_t& quote_position);
+        bool endNumber();
+        bool endLiteral();
+        void valueEnded();
+        void closeArray();
+        void closeObject();
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //JsonStreamParser class member function
+
+    template <typename Alloc>
+    inline JsonStreamParser<Alloc>::JsonStreamParser(const Alloc& a, const ParseOptions& o) : builder(a, o) {}
+
+    template <typename Alloc>
+    JsonStreamStatus JsonStreamParser<Alloc>::feed(const_char_ptr ptr, const size_t& size) {
+        size_t k = 0;
+        while (k < size && state != State::Error) {
+            if (state != State::String) {
+                if (!step(ptr[k])) {
+                    error_position = consumed + k;
+                    state = State::Error;
+                    break;
+                }
+                ++k;
+                continue;
+            }
+            //the body of a string is copied in runs, escapes are decoded once the closing quote is seen
+            if (escape_pending) {
+                token.push_back(ptr[k++]);
+                escape_pending = false;
+                continue;
+            }
+            auto quote = static_cast<const_char_ptr>(std::memchr(ptr + k, '"', size - k));
+            size_t end = quote ? quote - ptr : size;
+            auto backslash = static_cast<const_char_ptr>(std::memchr(ptr + k, '\\', end - k));
+            if (backslash) {
+                token.append(ptr + k, backslash - ptr - k + 1);
+                k = backslash - ptr + 1;
+                escape_pending = true;
+                continue;
+            }
+            token.append(ptr + k, end - k);
+            k = end;
+            if (quote) {
+                ++k;
+                if (!endString(consumed + k - 1)) {
+                    state = State::Error;
+                }
+            }
+        }
+        consumed += k;
+        return status();
+    }
+
+    template <typename Alloc>
+    JsonStreamStatus JsonStreamParser<Alloc>::finish() {
+        if (state == State::Number && !endNumber()) {
+            error_position = consumed;
+            state = State::Error;
+        }
+        else if (state == State::Literal && !endLiteral()) {
+            error_position = consumed;
+            state = State::Error;
+        }
+        if (state != State::Done && state != State::Error) {
+            error_position = consumed;
+            state = State::Error;
+        }
+        return status();
+    }
+
+    template <typename Alloc>
+    inline JsonStreamStatus JsonStreamParser<Alloc>::status() const {
+        switch (state) {
+            case State::Done: return JsonStreamStatus::Done;
+            case State::Error: return JsonStreamStatus::Error;
+            default: return JsonStreamStatus::NeedMore;
+        }
+    }
+
+    //moves the finished document out, the parser can then be reset for the next one
+    template <typename Alloc>
+    bool JsonStreamParser<Alloc>::take(Json<Alloc>& json_ref) {
+        return state == State::Done && builder.take(json_ref);
+    }
+
+    template <typename Alloc>
+    void JsonStreamParser<Alloc>::reset() {
+        state = State::Value;
+        is_key = false;
+        escape_pending = false;
+        token.clear();
+        frames.clear();
+        builder.clear();
+        consumed = 0;
+        error_position = 0;
+    }
+
+    //handles one byte outside of a string body, returns false on a syntax error
+    template <typename Alloc>
+    bool JsonStreamParser<Alloc>::step(const char& ch) {
+    again:
+        switch (state) {
+            case State::Value: {
+                switch (ch) {
+                    case ' ': case '\t': case '\n': case '\r': return true;
+                    case '{': {
+                        if (!builder.startObject()) {
+                            return false;
+                        }
+                        frames.push_back(JsonType::Object);
+                        state = State::FirstKey;
+                        return true;
+                    }
+                    case '[': {
+                        if (!builder.startArray()) {
+                            return false;
+                        }
+                        frames.push_back(JsonType::Array);
+                        state = State::FirstElement;
+                        return true;
+                    }
+                    case '"': {
+                        token.clear();
+                        is_key = false;
+                        state = State::String;
+                        return true;
+                    }
+                    case 't': case 'f': case 'n': {
+                        token.assign(1, ch);
+                        state = State::Literal;
+                        return true;
+                    }
+                    default: {
+                        if (ch != '-' && !isDigit(ch)) {
+                            return false;
+                        }
+                        token.assign(1, ch);
+                        state = State::Number;
+                        return true;
+                    }
+                }
+            }
+            case State::FirstElement: {
+                if (isWhiteSpace(ch)) {
+                    return true;
+                }
+                if (ch == ']') {
+                    closeArray();
+                    return true;
+                }
+                state = State::Value;
+                goto again;
+            }
+            case State::FirstKey:
+            case State::Key: {
+                if (isWhiteSpace(ch)) {
+                    return true;
+                }
+                if (ch == '}' && state == State::FirstKey) {
+                    closeObject();
+                    return true;
+                }
+                if (ch != '"') {
+                    return false;
+                }
+                token.clear();
+                is_key = true;
+                state = State::String;
+                return true;
+            }
+            case State::Colon: {
+                if (isWhiteSpace(ch)) {
+                    return true;
+                }
+                if (ch != ':') {
+                    return false;
+                }
+                state = State::Value;
+                return true;
+            }
+            case State::Next: {
+                if (isWhiteSpace(ch)) {
+                    return true;
+                }
+                auto type = frames.back();
+                if (ch == ',') {
+                    state = type == JsonType::Object ? State::Key : State::Value;
+                    return true;
+                }
+                if (type == JsonType::Object && ch == '}') {
+                    closeObject();
+                    return true;
+                }
+                if (type == JsonType::Array && ch == ']') {
+                    closeArray();
+                    return true;
+                }
+                return false;
+            }
+            case State::Number: {
+                if (isDigit(ch) || ch == '.' || ch == 'e' || ch == 'E' || ch == '+' || ch == '-') {
+                    token.push_back(ch);
+                    return true;
+                }
+                if (!endNumber()) {
+                    return false;
+                }
+                goto again;
+            }
+            case State::Literal: {
+                if (ch >= 'a' && ch <= 'z') {
+                    token.push_back(ch);
+                    return true;
+                }
+                if (!endLiteral()) {
+                    return false;
+                }
+                goto again;
+            }
+            case State::Done: {
+                return isWhiteSpace(ch);
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    //token is the raw body of the string that ends at quote_position, so an error is reported at the offending control
+    //character or backslash, like the DOM parser does
+    template <typename Alloc>
+    bool JsonStreamParser<Alloc>::endString(const size_t& quote_position) {
+        size_t start = quote_position - token.size();
+        for (size_t k = 0; k < token.size(); ++k) {
+            if (static_cast<unsigned char>(token[k]) < 0x20) {
+                error_position = start + k;
+                return false;
+            }
+        }
+        scratch.resize(token.size());
+        size_t position = 0;
+        size_t written;
+        if (!unescapeString(token.data(), position, token.size(), scratch.data(), written)) {
+            error_position = start + position;
+            return false;
+        }
+        if (is_key) {
+            builder.key(scratch.data(), written, false);
+            state = State::Colon;
+        }
+        else {
+            builder.string(scratch.data(), written, false);
+            valueEnded();
+        }
+        return true;
+    }
+
+    template <typename Alloc>
+    bool JsonStreamParser<Alloc>::endNumber() {
+        size_t position = 0;
+        bool is_decimal;
+        if (!scanNumber(token.data(), token.size(), position, is_decimal) || position != token.size()) {
+            return false;
+        }
+        auto begin = token.data();
+        auto end = begin + token.size();
+        long temp_l;
+        if (!is_decimal && std::from_chars(begin, end, temp_l).ec == std::errc()) {
+            builder.integer(temp_l);
+        }
+        else {
+            double temp_d;
+            if (!parseDecimal(begin, end, temp_d)) {
+                return false;
+            }
+            builder.decimal(temp_d);
+        }
+        valueEnded();
+        return true;
+    }
+
+    template <typename Alloc>
+    bool JsonStreamParser<Alloc>::endLiteral() {
+        if (token == "true") {
+            builder.boolean(true);
+        }
+        else if (token == "false") {
+            builder.boolean(false);
+        }
+        else if (token == "null") {
+            builder.null();
+        }
+        else {
+            return false;
+        }
+        valueEnded();
+        return true;
+    }
+
+    template <typename Alloc>
+    inline void JsonStreamParser<Alloc>::valueEnded() {
+        state = frames.empty() ? State::Done : State::Next;
+    }
+
+    template <typename Alloc>
+    inline void JsonStreamParser<Alloc>::closeArray() {
+        frames.pop_back();
+        builder.endArray();
+        valueEnded();
+    }
+
+    template <typename Alloc>
+    inline void JsonStreamParser<Alloc>::closeObject() {
+        frames.pop_back();
+        builder.endObject();
+        valueEnded();
+    }
+}
@@ -0,0 +1,324 @@
+#pragma once
+#include "Utility.h"
+#include <cstdint>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define JSONCPP_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace Jsoncpp {
+    enum class SimdLevel { Scalar, Sse42, Avx2 };
+
+    //bitmasks of one 64 byte block, bit k describes block[k]
+    struct JsonBlockMasks {
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t op;
+        uint64_t whitespace;
+        uint64_t control;
+    };
+
+    //JsonStructuralIndex class
+    //positions of every unescaped quote, every brace, bracket, colon and comma outside strings and the first byte of every scalar.
+    //build() indexes the whole input at once, buildNext() indexes it one window at a time and carries the string and
+    //escape state across windows, so the index stays small however large the input is
+    struct JsonStructuralIndex {
+        static constexpr size_t block_size = 64;
+        static constexpr size_t max_size = std::numeric_limits<uint32_t>::max();
+        static constexpr size_t no_error = std::numeric_limits<size_t>::max();
+
+        std::unique_ptr<uint32_t[]> positions;
+        size_t count = 0;
+        size_t capacity = 0;
+        size_t error_position = no_error;
+        //positions are relative to base, the start of the current window, indexed is where the next window starts
+        size_t base = 0;
+        size_t indexed = 0;
+        uint64_t prev_escaped = 0;
+        uint64_t prev_in_string = 0;
+        uint64_t prev_scalar = 0;
+
+        bool build(const_char_ptr ptr, const size_t& size);
+        bool build(const_char_ptr ptr, const size_t& size, const SimdLevel& level);
+        void start();
+        bool buildNext(const_char_ptr ptr, const size_t& size, const size_t& window);
+        bool buildNext(const_char_ptr ptr, const size_t& size, const size_t& window, const SimdLevel& level);
+        size_t operator[](const size_t& index) const;
+        template <void (*classify)(const unsigned char *, JsonBlockMasks &)>
+        void indexBlocks(const_char_ptr ptr, const size_t& end, const size_t& size);
+        void reserve(const size_t& num);
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    inline SimdLevel detectSimdLevel() {
+#ifdef JSONCPP_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::Avx2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return SimdLevel::Sse42;
+        }
+#endif
+        return SimdLevel::Scalar;
+    }
+
+    inline SimdLevel simdLevel() {
+        static const SimdLevel level = detectSimdLevel();
+        return level;
+    }
+
+    inline uint64_t prefixXor(uint64_t bits) {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+    inline void classifyBlockScalar(const unsigned char *block, JsonBlockMasks& masks) {
+        masks = {};
+        for (size_t k = 0; k < JsonStructuralIndex::block_size; ++k) {
+            uint64_t bit = uint64_t(1) << k;
+            switch (block[k]) {
+                case '"': {
+                    masks.quote |= bit;
+                    break;
+                }
+                case '\\': {
+                    masks.backslash |= bit;
+                    break;
+                }
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',': {
+                    masks.op |= bit;
+                    break;
+                }
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r': {
+                    masks.whitespace |= bit;
+                    break;
+                }
+                default: {
+                    break;
+                }
+            }
+            if (block[k] < 0x20) {
+                masks.control |= bit;
+            }
+        }
+    }
+
+#ifdef JSONCPP_X86_SIMD
+    __attribute__((target("sse4.2")))
+    inline void classifyBlockSse42(const unsigned char *block, JsonBlockMasks& masks) {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i open_brace = _mm_set1_epi8('{');
+        const __m128i close_brace = _mm_set1_epi8('}');
+        const __m128i colon = _mm_set1_epi8(':');
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i line_feed = _mm_set1_epi8('\n');
+        const __m128i carriage_return = _mm_set1_epi8('\r');
+        const __m128i lower_case = _mm_set1_epi8(0x20);
+        const __m128i control = _mm_set1_epi8(0x1F);
+        masks = {};
+        for (size_t k = 0; k < 4; ++k) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * k));
+            //'[' | 0x20 == '{' and ']' | 0x20 == '}'
+            __m128i folded = _mm_or_si128(chunk, lower_case);
+            __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, open_brace), _mm_cmpeq_epi8(folded, close_brace)),
+                                      _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)));
+            __m128i whitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                                              _mm_or_si128(_mm_cmpeq_epi8(chunk, line_feed), _mm_cmpeq_epi8(chunk, carriage_return)));
+            size_t shift = 16 * k;
+            masks.quote |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << shift;
+            masks.backslash |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)))) << shift;
+            masks.op |= uint64_t(uint32_t(_mm_movemask_epi8(op))) << shift;
+            masks.whitespace |= uint64_t(uint32_t(_mm_movemask_epi8(whitespace))) << shift;
+            masks.control |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk)))) << shift;
+        }
+    }
+
+    __attribute__((target("avx2")))
+    inline void classifyBlockAvx2(const unsigned char *block, JsonBlockMasks& masks) {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i open_brace = _mm256_set1_epi8('{');
+        const __m256i close_brace = _mm256_set1_epi8('}');
+        const __m256i colon = _mm256_set1_epi8(':');
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i line_feed = _mm256_set1_epi8('\n');
+        const __m256i carriage_return = _mm256_set1_epi8('\r');
+        const __m256i lower_case = _mm256_set1_epi8(0x20);
+        const __m256i control = _mm256_set1_epi8(0x1F);
+        masks = {};
+        for (size_t k = 0; k < 2; ++k) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32 * k));
+            __m256i folded = _mm256_or_si256(chunk, lower_case);
+            __m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, open_brace), _mm256_cmpeq_epi8(folded, close_brace)),
+                                         _mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, comma)));
+            __m256i whitespace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+                                                 _mm256_or_si256(_mm256_cmpeq_epi8(chunk, line_feed), _mm256_cmpeq_epi8(chunk, carriage_return)));
+            size_t shift = 32 * k;
+            masks.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)))) << shift;
+            masks.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash)))) << shift;
+            masks.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << shift;
+            masks.whitespace |= uint64_t(uint32_t(_mm256_movemask_epi8(whitespace))) << shift;
+            masks.control |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control), chunk)))) << shift;
+        }
+    }
+#endif
+
+    //JsonStructuralIndex class member function
+
+    inline void JsonStructuralIndex::reserve(const size_t& num) {
+        if (num <= capacity) {
+            return;
+        }
+        size_t new_capacity = capacity ? capacity : block_size;
+        while (new_capacity < num) {
+            new_capacity *= 2;
+        }
+        std::unique_ptr<uint32_t[]> temp(new uint32_t[new_capacity]);
+        if (count) {
+            std::memcpy(temp.get(), positions.get(), count * sizeof(uint32_t));
+        }
+        positions = std::move(temp);
+        capacity = new_capacity;
+    }
+
+    inline size_t JsonStructuralIndex::operator[](const size_t& index) const {
+        return base + positions[index];
+    }
+
+    //indexes the blocks from indexed up to end, only the last block of the input may be partial
+    template <void (*classify)(const unsigned char *, JsonBlockMasks &)>
+    void JsonStructuralIndex::indexBlocks(const_char_ptr ptr, const size_t& end, const size_t& size) {
+        constexpr uint64_t even_bits = 0x5555555555555555ULL;
+        unsigned char tail[block_size];
+        JsonBlockMasks masks;
+        base = indexed;
+        count = 0;
+        reserve((end - base) / 8 + block_size);
+        for (size_t offset = base; offset < end; offset += block_size) {
+            auto block = reinterpret_cast<const unsigned char *>(ptr + offset);
+            if (size - offset < block_size) {
+                std::memset(tail, ' ', block_size);
+                std::memcpy(tail, block, size - offset);
+                block = tail;
+            }
+            classify(block, masks);
+
+            //a backslash escapes the next byte unless it is itself escaped, odd length runs escape the byte after the run
+            uint64_t backslash = masks.backslash & ~prev_escaped;
+            uint64_t follows_escape = (backslash << 1) | prev_escaped;
+            uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+            uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+            prev_escaped = sequences_starting_on_even_bits < backslash;
+            uint64_t escaped = (even_bits ^ (sequences_starting_on_even_bits << 1)) & follows_escape;
+
+            //in_string covers the opening quote and the string body but not the closing quote
+            uint64_t quote = masks.quote & ~escaped;
+            uint64_t in_string = prefixXor(quote) ^ prev_in_string;
+            prev_in_string = uint64_t(static_cast<int64_t>(in_string) >> 63);
+
+            uint64_t outside = ~(in_string | quote);
+            uint64_t op = masks.op & outside;
+            uint64_t scalar = outside & ~masks.op & ~masks.whitespace;
+            uint64_t scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+            prev_scalar = scalar >> 63;
+
+            uint64_t errors = masks.control & in_string;
+            if (errors && error_position == no_error) {
+                error_position = offset + __builtin_ctzll(errors);
+            }
+
+            uint64_t structurals = op | quote | scalar_start;
+            reserve(count + block_size);
+            auto out = positions.get() + count;
+            while (structurals) {
+                *out++ = static_cast<uint32_t>(offset - base + __builtin_ctzll(structurals));
+                structurals &= structurals - 1;
+            }
+            count = out - positions.get();
+        }
+        indexed = end < size ? end : size;
+        if (indexed == size && prev_in_string && error_position == no_error) {
+            error_position = size;
+        }
+    }
+
+    inline void JsonStructuralIndex::start() {
+        count = 0;
+        error_position = no_error;
+        base = 0;
+        indexed = 0;
+        prev_escaped = 0;
+        prev_in_string = 0;
+        prev_scalar = 0;
+    }
+
+    //indexes the next window of the input, false once all of it has been indexed and the last window is left as it is.
+    //The window is rounded up to whole blocks
+    inline bool JsonStructuralIndex::buildNext(const_char_ptr ptr, const size_t& size, const size_t& window, const SimdLevel& level) {
+        if (indexed >= size) {
+            return false;
+        }
+        size_t length = (window + block_size - 1) / block_size * block_size;
+        if (length == 0 || length > max_size - block_size) {
+            length = max_size / block_size * block_size;
+        }
+        size_t end = size - indexed > length ? indexed + length : size;
+        switch (level) {
+#ifdef JSONCPP_X86_SIMD
+            case SimdLevel::Avx2: {
+                indexBlocks<classifyBlockAvx2>(ptr, end, size);
+                break;
+            }
+            case SimdLevel::Sse42: {
+                indexBlocks<classifyBlockSse42>(ptr, end, size);
+                break;
+            }
+#endif
+            default: {
+                indexBlocks<classifyBlockScalar>(ptr, end, size);
+                break;
+            }
+        }
+        return true;
+    }
+
+    inline bool JsonStructuralIndex::buildNext(const_char_ptr ptr, const size_t& size, const size_t& window) {
+        return buildNext(ptr, size, window, simdLevel());
+    }
+
+    inline bool JsonStructuralIndex::build(const_char_ptr ptr, const size_t& size, const SimdLevel& level) {
+        start();
+        if (size > max_size) {
+            error_position = max_size;
+            return false;
+        }
+        buildNext(ptr, size, size, level);
+        return error_position == no_error;
+    }
+
+    inline bool JsonStructuralIndex::build(const_char_ptr ptr, const size_t& size) {
+        return build(ptr, size, simdLevel());
+    }
+}
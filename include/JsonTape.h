@@ -0,0 +1,465 @@
+#pragma once
+#include "JsonParser.h"
+#include <string_view>
+
+namespace Jsoncpp {
+    struct JsonTape;
+
+    //JsonTapeValue class
+    //a position on a JsonTape, a default constructed value is the "not found" result of lookups
+    struct JsonTapeValue {
+        const JsonTape *document = nullptr;
+        size_t position = 0;
+
+        JsonTapeValue() = default;
+        JsonTapeValue(const JsonTape *d, const size_t& p);
+        explicit operator bool() const;
+        char tag() const;
+        JsonType type() const;
+        bool boolean() const;
+        long integer() const;
+        double decimal() const;
+        std::string_view string() const;
+        size_t next() const;
+    };
+
+    //JsonTapeArrayIterator class
+    struct JsonTapeArrayIterator {
+        JsonTapeValue value;
+
+        JsonTapeValue operator*() const;
+        JsonTapeArrayIterator &operator++();
+        bool operator==(const JsonTapeArrayIterator &other) const;
+        bool operator!=(const JsonTapeArrayIterator &other) const;
+    };
+
+    //JsonTapeArray class
+    //operator[] skips the elements before index, each skip is a single tape read
+    struct JsonTapeArray : public JsonTapeValue {
+        JsonTapeArray(const JsonTapeValue& value);
+        size_t length() const;
+        JsonTapeValue operator[](const size_t& index) const;
+        JsonTapeArrayIterator begin() const;
+        JsonTapeArrayIterator end() const;
+    };
+
+    //JsonTapeMember class
+    struct JsonTapeMember {
+        std::string_view key;
+        JsonTapeValue value;
+    };
+
+    //JsonTapeObjectIterator class
+    struct JsonTapeObjectIterator {
+        JsonTapeValue key;
+
+        JsonTapeMember operator*() const;
+        JsonTapeObjectIterator &operator++();
+        bool operator==(const JsonTapeObjectIterator &other) const;
+        bool operator!=(const JsonTapeObjectIterator &other) const;
+    };
+
+    //JsonTapeObject class
+    //at() compares keys in document order and skips over the values of the ones that do not match
+    struct JsonTapeObject : public JsonTapeValue {
+        JsonTapeObject(const JsonTapeValue& value);
+        size_t length() const;
+        JsonTapeValue at(const std::string_view& key) const;
+        JsonTapeObjectIterator begin() const;
+        JsonTapeObjectIterator end() const;
+    };
+
+    //JsonTape class
+    //immutable document: every value is one 64 bit word in document order, numbers take a second word for their bits.
+    //The top byte of a word is its tag and the rest the payload. An opening '[' or '{' holds its element count in bits
+    //32 to 55 and the index one past its closing word in the low 32 bits, so a subtree is skipped without walking it.
+    //A '"' word holds an offset into the string buffer, where each string is a 32 bit length, the bytes and a 0
+    struct JsonTape {
+        static constexpr uint64_t payload_mask = (uint64_t(1) << 56) - 1;
+        static constexpr uint64_t max_count = 0xFFFFFF;
+
+        std::unique_ptr<uint64_t[]> tape;
+        size_t tape_length = 0;
+        size_t tape_capacity = 0;
+        std::unique_ptr<char[]> strings;
+        size_t strings_length = 0;
+        size_t strings_capacity = 0;
+        //an array or object opened deeper than this fails the parse at its bracket
+        size_t max_depth = default_max_depth;
+
+        bool parse(const_char_ptr ptr, const size_t& size);
+        bool parse(const_char_ptr ptr, const size_t& size, size_t& error_position);
+        JsonTapeValue root() const;
+        void reserve(const size_t& words, const size_t& bytes);
+        static uint64_t word(const char& tag, const uint64_t& payload);
+    };
+
+    //JsonTapeBuilder class
+    //the JsonSaxHandler that fills a JsonTape. The whole input is indexed before the first event so the tape and the
+    //string buffer can be sized up front and building never reallocates
+    struct JsonTapeBuilder {
+        struct Frame {
+            size_t start;
+            size_t count;
+        };
+
+        std::vector<Frame> frames;
+        JsonTape &document;
+
+        JsonTapeBuilder(JsonTape &d);
+        bool startObject();
+        bool endObject();
+        bool startArray();
+        bool endArray();
+        bool key(const_char_ptr ptr, const size_t& length, const bool& in_input);
+        bool string(const_char_ptr ptr, const size_t& length, const bool& in_input);
+        bool integer(const long& value);
+        bool decimal(const double& value);
+        bool boolean(const bool& value);
+        bool null();
+        void element();
+        void append(const uint64_t& value);
+        void open(const char& tag);
+        void close(const char& tag);
+        void appendString(const_char_ptr ptr, const size_t& length);
+    };
+
+    /*Functions--------------------------------------------------------------------------------------------------------------------------------*/
+
+    //JsonTapeValue class member function
+
+    inline JsonTapeValue::JsonTapeValue(const JsonTape *d, const size_t& p) : document(d), position(p) {}
+
+    inline JsonTapeValue::operator bool() const {
+        return document;
+    }
+
+    //0 for the "not found" value
+    inline char JsonTapeValue::tag() const {
+        return document ? static_cast<char>(document->tape[position] >> 56) : '\0';
+    }
+
+    inline JsonType JsonTapeValue::type() const {
+        switch (tag()) {
+            case 't':
+            case 'f': return JsonType::Boolean;
+            case 'l': return JsonType::Integer;
+            case 'd': return JsonType::Decimal;
+            case '"': return JsonType::String;
+            case '[': return JsonType::Array;
+            case '{': return JsonType::Object;
+            default: return JsonType::Null;
+        }
+    }
+
+    inline bool JsonTapeValue::boolean() const {
+        return tag() == 't';
+    }
+
+    //0 when the value is not an integer
+    inline long JsonTapeValue::integer() const {
+        return tag() == 'l' ? static_cast<long>(document->tape[position + 1]) : 0;
+    }
+
+    //0 when the value is not a decimal
+    inline double JsonTapeValue::decimal() const {
+        double result = 0;
+        if (tag() == 'd') {
+            std::memcpy(&result, &document->tape[position + 1], sizeof(result));
+        }
+        return result;
+    }
+
+    //empty when the value is not a string
+    inline std::string_view JsonTapeValue::string() const {
+        if (tag() != '"') {
+            return std::string_view();
+        }
+        auto ptr = document->strings.get() + (document->tape[position] & JsonTape::payload_mask);
+        uint32_t length;
+        std::memcpy(&length, ptr, sizeof(length));
+        return std::string_view(ptr + sizeof(length), length);
+    }
+
+    //the index of the value that follows this one and all of its children
+    inline size_t JsonTapeValue::next() const {
+        switch (tag()) {
+            case '[':
+            case '{': return static_cast<uint32_t>(document->tape[position]);
+            case 'l':
+            case 'd': return position + 2;
+            default: return position + 1;
+        }
+    }
+
+    //JsonTapeArrayIterator class member function
+
+    inline JsonTapeValue JsonTapeArrayIterator::operator*() const {
+        return value;
+    }
+
+    inline JsonTapeArrayIterator& JsonTapeArrayIterator::operator++() {
+        value.position = value.next();
+        return *this;
+    }
+
+    inline bool JsonTapeArrayIterator::operator==(const JsonTapeArrayIterator& other) const {
+        return value.position == other.value.position;
+    }
+
+    inline bool JsonTapeArrayIterator::operator!=(const JsonTapeArrayIterator& other) const {
+        return value.position != other.value.position;
+    }
+
+    //JsonTapeArray class member function
+
+    //anything but an array gives the "not found" value, which reads as empty
+    inline JsonTapeArray::JsonTapeArray(const JsonTapeValue& value) : JsonTapeValue(value.tag() == '[' ? value : JsonTapeValue()) {}
+
+    //counts past max_count are not stored and have to be walked
+    inline size_t JsonTapeArray::length() const {
+        if (!document) {
+            return 0;
+        }
+        size_t result = (document->tape[position] >> 32) & JsonTape::max_count;
+        if (result < JsonTape::max_count) {
+            return result;
+        }
+        result = 0;
+        for (auto it = begin(); it != end(); ++it) {
+            ++result;
+        }
+        return result;
+    }
+
+    inline JsonTapeValue JsonTapeArray::operator[](const size_t& index) const {
+        auto it = begin();
+        for (size_t k = 0; k < index && it != end(); ++k) {
+            ++it;
+        }
+        if (it == end()) {
+            return JsonTapeValue();
+        }
+        return *it;
+    }
+
+    inline JsonTapeArrayIterator JsonTapeArray::begin() const {
+        return {document ? JsonTapeValue(document, position + 1) : JsonTapeValue()};
+    }
+
+    inline JsonTapeArrayIterator JsonTapeArray::end() const {
+        return {document ? JsonTapeValue(document, next() - 1) : JsonTapeValue()};
+    }
+
+    //JsonTapeObjectIterator class member function
+
+    inline JsonTapeMember JsonTapeObjectIterator::operator*() const {
+        return {key.string(), JsonTapeValue(key.document, key.position + 1)};
+    }
+
+    inline JsonTapeObjectIterator& JsonTapeObjectIterator::operator++() {
+        key.position = JsonTapeValue(key.document, key.position + 1).next();
+        return *this;
+    }
+
+    inline bool JsonTapeObjectIterator::operator==(const JsonTapeObjectIterator& other) const {
+        return key.position == other.key.position;
+    }
+
+    inline bool JsonTapeObjectIterator::operator!=(const JsonTapeObjectIterator& other) const {
+        return key.position != other.key.position;
+    }
+
+    //JsonTapeObject class member function
+
+    //anything but an object gives the "not found" value, which reads as empty
+    inline JsonTapeObject::JsonTapeObject(const JsonTapeValue& value) : JsonTapeValue(value.tag() == '{' ? value : JsonTapeValue()) {}
+
+    inline size_t JsonTapeObject::length() const {
+        if (!document) {
+            return 0;
+        }
+        size_t result = (document->tape[position] >> 32) & JsonTape::max_count;
+        if (result < JsonTape::max_count) {
+            return result;
+        }
+        result = 0;
+        for (auto it = begin(); it != end(); ++it) {
+            ++result;
+        }
+        return result;
+    }
+
+    inline JsonTapeValue JsonTapeObject::at(const std::string_view& key) const {
+        for (auto it = begin(); it != end(); ++it) {
+            if (it.key.string() == key) {
+                return JsonTapeValue(document, it.key.position + 1);
+            }
+        }
+        return JsonTapeValue();
+    }
+
+    inline JsonTapeObjectIterator JsonTapeObject::begin() const {
+        return {document ? JsonTapeValue(document, position + 1) : JsonTapeValue()};
+    }
+
+    inline JsonTapeObjectIterator JsonTapeObject::end() const {
+        return {document ? JsonTapeValue(document, next() - 1) : JsonTapeValue()};
+    }
+
+    //JsonTape class member function
+
+    //the input is indexed in one window so the buffers can be sized from it: every structural becomes at most two words
+    //and every string costs at most its raw bytes plus 5
+    inline bool JsonTape::parse(const_char_ptr ptr, const size_t& size, size_t& error_position) {
+        JsonTapeBuilder builder(*this);
+        JsonSaxParser<JsonTapeBuilder> reader(ptr, size, builder, size);
+        tape_length = 0;
+        strings_length = 0;
+        reader.index.start();
+        if (size > JsonStructuralIndex::max_size || !reader.index.buildNext(ptr, size, size) || 2 * reader.index.count + 1 > UINT32_MAX) {
+            error_position = 0;
+            return false;
+        }
+        reserve(2 * reader.index.count + 1, size + 3 * reader.index.count + 1);
+        if (reader.parseIndexed()) {
+            return true;
+        }
+        error_position = reader.position;
+        tape_length = 0;
+        strings_length = 0;
+        return false;
+    }
+
+    inline bool JsonTape::parse(const_char_ptr ptr, const size_t& size) {
+        size_t error_position;
+        return parse(ptr, size, error_position);
+    }
+
+    inline JsonTapeValue JsonTape::root() const {
+        return JsonTapeValue(this, 0);
+    }
+
+    //buffers only grow, a tape reused for many documents stops allocating once it has seen the largest
+    inline void JsonTape::reserve(const size_t& words, const size_t& bytes) {
+        if (words > tape_capacity) {
+            tape.reset(new uint64_t[words]);
+            tape_capacity = words;
+        }
+        if (bytes > strings_capacity) {
+            strings.reset(new char[bytes]);
+            strings_capacity = bytes;
+        }
+    }
+
+    inline uint64_t JsonTape::word(const char& tag, const uint64_t& payload) {
+        return (uint64_t(static_cast<unsigned char>(tag)) << 56) | payload;
+    }
+
+    //JsonTapeBuilder class member function
+
+    inline JsonTapeBuilder::JsonTapeBuilder(JsonTape &d) : document(d) {}
+
+    //array elements are counted as they start, object members by their key
+    inline void JsonTapeBuilder::element() {
+        if (!frames.empty() && document.tape[frames.back().start] >> 56 == '[') {
+            ++frames.back().count;
+        }
+    }
+
+    inline void JsonTapeBuilder::append(const uint64_t& value) {
+        document.tape[document.tape_length++] = value;
+    }
+
+    inline void JsonTapeBuilder::open(const char& tag) {
+        element();
+        frames.push_back({document.tape_length, 0});
+        append(JsonTape::word(tag, 0));
+    }
+
+    //patches the opening word now that the end and the count are known
+    inline void JsonTapeBuilder::close(const char& tag) {
+        auto frame = frames.back();
+        frames.pop_back();
+        append(JsonTape::word(tag, frame.start));
+        uint64_t count = frame.count < JsonTape::max_count ? frame.count : JsonTape::max_count;
+        document.tape[frame.start] |= (count << 32) | document.tape_length;
+    }
+
+    inline void JsonTapeBuilder::appendString(const_char_ptr ptr, const size_t& length) {
+        auto offset = document.strings_length;
+        auto des = document.strings.get() + offset;
+        auto l = static_cast<uint32_t>(length);
+        std::memcpy(des, &l, sizeof(l));
+        std::memcpy(des + sizeof(l), ptr, length);
+        des[sizeof(l) + length] = 0;
+        document.strings_length += sizeof(l) + length + 1;
+        append(JsonTape::word('"', offset));
+    }
+
+    inline bool JsonTapeBuilder::startObject() {
+        if (frames.size() >= document.max_depth) {
+            return false;
+        }
+        open('{');
+        return true;
+    }
+
+    inline bool JsonTapeBuilder::endObject() {
+        close('}');
+        return true;
+    }
+
+    inline bool JsonTapeBuilder::startArray() {
+        if (frames.size() >= document.max_depth) {
+            return false;
+        }
+        open('[');
+        return true;
+    }
+
+    inline bool JsonTapeBuilder::endArray() {
+        close(']');
+        return true;
+    }
+
+    inline bool JsonTapeBuilder::key(const_char_ptr ptr, const size_t& length, const bool&) {
+        ++frames.back().count;
+        appendString(ptr, length);
+        return true;
+    }
+
+    inline bool JsonTapeBuilder::string(const_char_ptr ptr, const size_t& length, const bool&) {
+        element();
+        appendString(ptr, length);
+        return true;
+    }
+
+    inline bool JsonTapeBuilder::integer(const long& value) {
+        element();
+        append(JsonTape::word('l', 0));
+        append(static_cast<uint64_t>(value));
+        return true;
+    }
+
+    inline bool JsonTapeBuilder::decimal(const double& value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        element();
+        append(JsonTape::word('d', 0));
+        append(bits);
+        return true;
+    }
+
+    inline bool JsonTapeBuilder::boolean(const bool& value) {
+        element();
+        append(JsonTape::word(value ? 't' : 'f', 0));
+        return true;
+    }
+
+    inline bool JsonTapeBuilder::null() {
+        element();
+        append(JsonTape::word('n', 0));
+        return true;
+    }
+}
@@ -1,12 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 #include <string_view>
-#include <functional>
 #include <charconv>
-#include <deque>
 #include <cstring>
 #include <cstdio>
 
@@ -30,27 +29,97 @@ namespace Jsoncpp {
     template <typename T>
     using removeConstReference = std::remove_reference_t<std::remove_const_t<T>>;
 
+    //element type behind a pointer or iterator
+    template <typename Ptr>
+    using pointee = removeConstReference<decltype(*std::declval<Ptr>())>;
+
+    //types an object of which can be moved to new storage with memcpy, the old bytes are then dropped without running
+    //the destructor. Node types specialize this next to their definition
+    template <typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+    template <typename T>
+    constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    //byte sized types compare with memcmp, equality of anything else goes through its operator==
+    template <typename T>
+    constexpr bool is_bytewise_comparable = std::is_integral_v<T> && sizeof(T) == 1;
+
     template <typename Ptr>
     void movePtrElement(Ptr des, Ptr src, const size_t& num) {
-        for (size_t k = 0; k < num; ++k) {
-            des[k] = std::move(src[k]);
+        if constexpr (std::is_pointer_v<Ptr> && std::is_trivially_copyable_v<pointee<Ptr>>) {
+            if (num) {
+                std::memmove(des, src, num * sizeof(pointee<Ptr>));
+            }
+        }
+        else {
+            for (size_t k = 0; k < num; ++k) {
+                des[k] = std::move(src[k]);
+            }
         }
     }
 
     template <typename Ptr>
     bool compare(Ptr ptr0, Ptr ptr1, const size_t& length) {
-        for (size_t k = 0; k < length; ++k) {
-            if (ptr0[k] != ptr1[k]) {
-                return false;
+        if constexpr (std::is_pointer_v<Ptr> && is_bytewise_comparable<pointee<Ptr>>) {
+            return !length || std::memcmp(ptr0, ptr1, length) == 0;
+        }
+        else {
+            for (size_t k = 0; k < length; ++k) {
+                if (ptr0[k] != ptr1[k]) {
+                    return false;
+                }
             }
+            return true;
         }
-        return true;
     }
 
     template <typename Ptr>
     void copyPtrElement(Ptr des, Ptr src, const size_t& num) {
+        if constexpr (std::is_pointer_v<Ptr> && std::is_trivially_copyable_v<pointee<Ptr>>) {
+            if (num) {
+                std::memmove(des, src, num * sizeof(pointee<Ptr>));
+            }
+        }
+        else {
+            for (size_t k = 0; k < num; ++k) {
+                des[k] = src[k];
+            }
+        }
+    }
+
+    template <typename T>
+    void constructCopyPtrElement(T* des, const T* src, const size_t& num) {
+        for (size_t k = 0; k < num; ++k) {
+            new (des + k) T(src[k]);
+        }
+    }
+
+    template <typename T>
+    void constructMovePtrElement(T* des, T* src, const size_t& num) {
+        for (size_t k = 0; k < num; ++k) {
+            new (des + k) T(std::move(src[k]));
+        }
+    }
+
+    template <typename T>
+    void destroyPtrElement(T* ptr, const size_t& num) {
         for (size_t k = 0; k < num; ++k) {
-            des[k] = src[k];
+            ptr[k].~T();
+        }
+    }
+
+    //moves num objects to uninitialized des and ends the lifetime of the ones at src, the ranges must not overlap
+    template <typename T>
+    void relocatePtrElement(T* des, T* src, const size_t& num) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (num) {
+                std::memcpy(static_cast<void *>(des), static_cast<const void *>(src), num * sizeof(T));
+            }
+        }
+        else {
+            constructMovePtrElement(des, src, num);
+            destroyPtrElement(src, num);
         }
     }
 
@@ -83,25 +152,23 @@ namespace Jsoncpp {
 
     }*/
 
+    //the C locale's isspace
+    constexpr bool isSpace(const char& ch) {
+        return ch == ' ' || (ch >= '\t' && ch <= '\r');
+    }
+
+    //an input of only white space trims to an empty view
     template <typename Ptr, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
     std::string_view trimWhiteSpace(Ptr ptr, const size_t& size) {
-        Ptr result = ptr;
-        size_t len = size;
-        for (size_t k = 0; k < size; ++k) {
-            if (ptr[k] != ' ' & ptr[k] != '\t' & ptr[k] != '\n' & ptr[k] != '\v' & ptr[k] != '\f' & ptr[k] != '\r') {
-                result += k;
-                len -= k;
-                break;
-            }
+        size_t begin = 0;
+        size_t end = size;
+        while (begin < end && isSpace(ptr[begin])) {
+            ++begin;
         }
-        for (size_t k = 1; k <= size; ++k) {
-            auto &ch = ptr[size - k];
-            if (ch != ' ' & ch != '\t' & ch != '\n' & ch != '\v' & ch != '\f' & ch != '\r') {
-                len -= (k - 1);
-                break;
-            }
+        while (end > begin && isSpace(ptr[end - 1])) {
+            --end;
         }
-        return std::string_view(result, len);
+        return std::string_view(ptr + begin, end - begin);
     }
 
 
@@ -145,37 +212,50 @@ namespace Jsoncpp {
         }
     }
 
+    //deepest nesting findClosingBrace follows before giving up
+    constexpr size_t max_brace_depth = 256;
+
+    //po must be at an opening brace or quote. Inside a string only the closing quote counts, the expected closers sit on
+    //a fixed stack so nothing is allocated
     template <typename Ptr>
     size_t findClosingBrace(Ptr ptr, const size_t& size, const size_t& po) {
-        std::deque<char> close_braces;
-        auto search_brace = getMatchingBrace(ptr[po]);
-        if (search_brace)
-        {
-            close_braces.push_back(search_brace);
-            for (size_t k = po + 1; k < size; ++k) {
-                auto &cur_char = ptr[k];
-                if (cur_char == '\\')
-                {
-                    ++k;
-                    continue;
-                }
-                auto cur_close_brace = getMatchingClosingBrace(cur_char);
-                if (cur_char == close_braces.back()) {
-                    close_braces.pop_back();
-                }
-                else if (cur_close_brace) {
-                    close_braces.push_back(cur_close_brace);
-                }
-                if (close_braces.size() == 0) {
+        char close_braces[max_brace_depth];
+        size_t depth = 0;
+        auto search_brace = getMatchingClosingBrace(ptr[po]);
+        if (!search_brace) {
+            return size;
+        }
+        close_braces[depth++] = search_brace;
+        for (size_t k = po + 1; k < size; ++k) {
+            auto &cur_char = ptr[k];
+            if (cur_char == '\\') {
+                ++k;
+                continue;
+            }
+            if (cur_char == close_braces[depth - 1]) {
+                if (--depth == 0) {
                     return k;
                 }
+                continue;
+            }
+            if (close_braces[depth - 1] == '"') {
+                continue;
+            }
+            auto cur_close_brace = getMatchingClosingBrace(cur_char);
+            if (cur_close_brace) {
+                if (depth == max_brace_depth) {
+                    return size;
+                }
+                close_braces[depth++] = cur_close_brace;
             }
         }
         return size;
     }
 
-    template <char ch, typename Ptr, bool ignore_brace = false, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
-    void splitToView(Ptr ptr, const size_t& size, const std::function<void(const std::string_view&)>& func) {
+    //calls func with every piece between separators ch, separators inside braces and strings are skipped unless
+    //ignore_brace. func is any callable taking a std::string_view and is called directly
+    template <char ch, typename Ptr, bool ignore_brace = false, typename Func, typename = std::enable_if_t<convertible_to_char_pointer<Ptr>>>
+    void splitToView(Ptr ptr, const size_t& size, Func&& func) {
         size_t pre = 0;
         for (size_t k = 0; k < size;)
         {
@@ -186,10 +266,10 @@ namespace Jsoncpp {
             }
             if (cur_char == ch) {
                 func(std::string_view(ptr + pre, k - pre));
-                pre = k++;
+                pre = ++k;
                 continue;
             }
-            if (!ignore_brace) {
+            if (!ignore_brace && getMatchingClosingBrace(cur_char)) {
                 auto match_brace = findClosingBrace(ptr, size, k);
                 if (match_brace != size) {
                     k = match_brace + 1;
@@ -201,4 +281,3 @@ namespace Jsoncpp {
         func(std::string_view(ptr + pre, size - pre));
     }
 }
-
@@ -0,0 +1,80 @@
+#include "JsonCpp.h"
+#include <cassert>
+#include <string>
+
+using namespace Jsoncpp;
+
+using DocumentArray = JsonArray<JsonDocument::allocator_type>;
+
+void testNotFound() {
+    const std::string text = "{\"a\":[1,2.5,\"s\"],\"b\":false}";
+    JsonDocumentView view(text.data(), text.size());
+    assert(!view["missing"] && view["missing"].type() == JsonType::Null);
+    assert(JsonDocumentView().type() == JsonType::Null && !JsonDocumentView().asBoolean());
+    assert(view["b"].isBoolean() && !view["b"].asBoolean() && !view["a"].isBoolean());
+    assert(view["a"][1].asDecimal() == 2.5 && !view["a"][3]);
+    assert(JsonPointer("/a/2").evaluate(view).asString() == "s");
+    assert(!JsonPointer("/a/7").evaluate(view));
+
+    JsonTape tape;
+    size_t error_position;
+    assert(tape.parse(text.data(), text.size(), error_position));
+    JsonTapeObject root(tape.root());
+    JsonTapeValue none;
+    assert(!none && none.type() == JsonType::Null && none.integer() == 0 && none.string().empty());
+    assert(!root.at("missing") && root.at("missing").type() == JsonType::Null);
+    JsonTapeArray array(root.at("a"));
+    assert(array.length() == 3 && array[0].integer() == 1 && array[2].string() == "s" && !array[3]);
+    JsonTapeArray mistyped(root.at("b"));
+    assert(!mistyped && mistyped.length() == 0 && mistyped.begin() == mistyped.end());
+    JsonTapeObject not_object(array);
+    assert(!not_object && not_object.length() == 0 && !not_object.at("a"));
+}
+
+void testCopiesOutliveParse() {
+    const std::string first = "[\"a string long enough for the heap\",{\"k\":[1,2]}]";
+    const std::string second = "[3,4,5,6,7,8,9,10]";
+    JsonDocument document;
+    assert(document.parse(first.data(), first.size()));
+    {
+        JsonDocument::value_type keep = document.root();
+        assert(document.parse(second.data(), second.size()));
+        assert(serialize(keep) == first);
+        assert(serialize(document.root()) == second);
+    }
+    assert(document.parse(first.data(), first.size()));
+    assert(document.retired.empty());
+
+    //a container that handed out a reference is cloned into the arena when copied
+    auto &array = *reinterpret_cast<DocumentArray *>(&document.root());
+    array[0];
+    JsonDocument::value_type clone = document.root();
+    assert(document.parse(second.data(), second.size()));
+    assert(serialize(clone) == first);
+}
+
+void testMovedFrom() {
+    const std::string text = "{\"a\":[1,2]}";
+    JsonDocument document;
+    assert(document.parse(text.data(), text.size()));
+    JsonDocument moved(std::move(document));
+    assert(serialize(moved.root()) == text);
+    assert(static_cast<const JsonDocument &>(document).root().type == JsonType::Null);
+    assert(document.root().type == JsonType::Null);
+    assert(document.parse(text.data(), text.size()));
+    assert(serialize(document.root()) == text);
+
+    JsonDocument assigned;
+    assigned = std::move(document);
+    assert(serialize(assigned.root()) == text);
+    document.clear();
+    document.root() = JsonString<JsonDocument::allocator_type>("a string long enough for the heap", document.allocator());
+    assert(serialize(document.root()) == "\"a string long enough for the heap\"");
+}
+
+int main() {
+    testNotFound();
+    testCopiesOutliveParse();
+    testMovedFrom();
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "JsonCpp.h"
+#include <cassert>
+#include <cmath>
+#include <string>
+
+using namespace Jsoncpp;
+
+//position of the error, SIZE_MAX when the text parses
+size_t domError(const std::string& text, const ParseOptions& options = ParseOptions()) {
+    Json<> json;
+    JsonParser<> parser(text.data(), text.size(), std::allocator<char>(), options);
+    return parser.parse(json) ? SIZE_MAX : parser.position;
+}
+
+size_t streamError(const std::string& text, const size_t& piece) {
+    JsonStreamParser<> parser;
+    for (size_t k = 0; k < text.size(); k += piece) {
+        parser.feed(text.data() + k, std::min(piece, text.size() - k));
+    }
+    return parser.finish() == JsonStreamStatus::Error ? parser.error_position : SIZE_MAX;
+}
+
+void testRoundTrip() {
+    const std::string texts[] = {
+        "null", "true", "-12", "2.5", "\"\"", "[]", "{}",
+        "{\"a\":[1,2.5,-3,true,false,null],\"b\":{\"c\":\"d\\\"e\\\\f\\n\"},\"long key for a heap string\":\"and a long value too\"}",
+        "[[[[]]],{\"x\":{}},[1,[2,[3]]]]"
+    };
+    for (auto &text : texts) {
+        Json<> json;
+        JsonParser<> parser(text.data(), text.size());
+        assert(parser.parse(json));
+        assert(serialize(json) == text);
+        JsonStreamParser<> stream;
+        for (auto &ch : text) {
+            stream.feed(&ch, 1);
+        }
+        Json<> streamed;
+        assert(stream.finish() == JsonStreamStatus::Done && stream.take(streamed));
+        assert(streamed == json);
+    }
+}
+
+void testErrorOffsets() {
+    struct Case {
+        std::string text;
+        size_t position;
+    };
+    const Case cases[] = {
+        {"[\"ab\\xcd\"]", 4},
+        {std::string("[\"ab\x01\"]"), 4},
+        {"{\"k\\q\":1}", 3},
+        {"[1,\"abc\\u12\"]", 7},
+        {"[1,]", 3},
+        {"{\"a\" 1}", 5},
+    };
+    for (auto &c : cases) {
+        assert(domError(c.text) == c.position);
+        for (size_t piece : {1, 2, 3, 64}) {
+            assert(streamError(c.text, piece) == c.position);
+        }
+    }
+}
+
+void testDepthLimit() {
+    ParseOptions options;
+    options.max_depth = 4;
+    assert(domError("[[[[1]]]]", options) == SIZE_MAX);
+    assert(domError("[[[[[1]]]]]", options) == 4);
+    std::string deep(default_max_depth + 1, '[');
+    deep += std::string(default_max_depth + 1, ']');
+    assert(domError(deep) == default_max_depth);
+}
+
+void testDecimals() {
+    const std::string text = "[1e-400,-1e400,0.1]";
+    Json<> json;
+    JsonParser<> parser(text.data(), text.size());
+    assert(parser.parse(json));
+    auto &array = *reinterpret_cast<const JsonArray<> *>(&json);
+    assert(array[0].type == JsonType::Decimal && array[0].json.decimal == 0.0);
+    assert(std::isinf(array[1].json.decimal) && array[1].json.decimal < 0);
+    assert(array[2].json.decimal == 0.1);
+}
+
+int main() {
+    testRoundTrip();
+    testErrorOffsets();
+    testDepthLimit();
+    testDecimals();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "JsonCpp.h"
+#include <cassert>
+#include <string>
+
+using namespace Jsoncpp;
+
+Json<> parseText(const std::string& text) {
+    Json<> json;
+    JsonParser<> parser(text.data(), text.size());
+    assert(parser.parse(json));
+    return json;
+}
+
+const JsonObject<>& asObject(const Json<>& json) {
+    return *reinterpret_cast<const JsonObject<> *>(&json);
+}
+
+const JsonArray<>& asArray(const Json<>& json) {
+    return *reinterpret_cast<const JsonArray<> *>(&json);
+}
+
+void testCopyIndependence() {
+    auto a = parseText("{\"x\":1,\"list\":[1,2,3],\"inner\":{\"y\":\"a string long enough for the heap\"}}");
+    Json<> b = a;
+    assert(b.json.pointer == a.json.pointer);
+    auto &object = *reinterpret_cast<JsonObject<> *>(&a);
+    object[JsonString<>("x")] = JsonInteger<>(2);
+    assert(asObject(b).at(JsonString<>("x"))->json.integer == 1);
+    assert(asObject(a).at(JsonString<>("x"))->json.integer == 2);
+
+    //a reference taken before the copy must not write into the copy
+    Json<> &x = object[JsonString<>("x")];
+    Json<> c = a;
+    x = JsonInteger<>(99);
+    assert(asObject(c).at(JsonString<>("x"))->json.integer == 2);
+
+    auto &list = *reinterpret_cast<JsonArray<> *>(object.at(JsonString<>("list")));
+    Json<> &added = list.emplaceBack(JsonInteger<>(4));
+    Json<> d = a;
+    added = JsonInteger<>(5);
+    assert(asArray(*asObject(d).at(JsonString<>("list")))[3].json.integer == 4);
+    assert(asArray(*asObject(a).at(JsonString<>("list")))[3].json.integer == 5);
+
+    Json<> e;
+    e = b;
+    reinterpret_cast<JsonObject<> *>(&b)->erase(JsonString<>("inner"));
+    assert(asObject(e).at(JsonString<>("inner")) && !asObject(b).at(JsonString<>("inner")));
+}
+
+void testHash() {
+    auto a = parseText("{\"x\":{},\"y\":[1,2]}");
+    auto b = parseText("{\"y\":[1,2],\"x\":{\"z\":5}}");
+    assert(a != b);
+    auto &object = *reinterpret_cast<JsonObject<> *>(&a);
+    auto &x = *reinterpret_cast<JsonObject<> *>(&object[JsonString<>("x")]);
+    size_t before = a.hash();
+    x[JsonString<>("z")] = JsonInteger<>(5);
+    assert(a.hash() != before);
+    assert(a.hash() == b.hash() && a == b);
+}
+
+void testDefaults() {
+    Json<> json;
+    assert(json.type == JsonType::Null && json == Json<>(JsonType::Null));
+    JsonArray<> array;
+    assert(array.length() == 0 && array.capacity() == 0);
+    JsonObject<> object;
+    assert(object.length() == 0 && !object.at(JsonString<>("missing")));
+    const auto &constant = object;
+    assert(!constant.at(JsonString<>("missing")));
+    JsonString<> string;
+    assert(string.length() == 0);
+}
+
+int main() {
+    testCopyIndependence();
+    testHash();
+    testDefaults();
+    return 0;
+}